@@ -0,0 +1,65 @@
+TARGET = benchmarks
+
+HEADERS = \
+   $$PWD/../contentwidget.h \
+   $$PWD/../theme.h \
+   $$PWD/../timelinewidget.h \
+   $$PWD/../tracking.h \
+   $$PWD/../timetracker.h \
+   $$PWD/../clock.h \
+   $$PWD/../lockstatewatcher.h \
+   $$PWD/../tickwatchdog.h \
+   $$PWD/../powerstatewatcher.h \
+   $$PWD/../inputidlewatcher.h \
+   $$PWD/../foregroundwatcher.h \
+   $$PWD/../historystore.h \
+   $$PWD/../segmentarchive.h \
+   $$PWD/../sharedhistory.h \
+   $$PWD/../hookrunner.h \
+   $$PWD/../dayrollover.h \
+   $$PWD/../notestore.h \
+   $$PWD/../projects.h \
+   $$PWD/../stringinterner.h \
+   $$PWD/../settings.h \
+   $$PWD/../metrics.h \
+   $$PWD/../types.h \
+   $$PWD/../helpers.h \
+   $$PWD/../logger.h
+
+SOURCES = \
+   $$PWD/tst_benchmarks.cpp \
+   $$PWD/../contentwidget.cpp \
+   $$PWD/../theme.cpp \
+   $$PWD/../timelinewidget.cpp \
+   $$PWD/../tracking.cpp \
+   $$PWD/../timetracker.cpp \
+   $$PWD/../clock.cpp \
+   $$PWD/../lockstatewatcher.cpp \
+   $$PWD/../tickwatchdog.cpp \
+   $$PWD/../powerstatewatcher.cpp \
+   $$PWD/../inputidlewatcher.cpp \
+   $$PWD/../foregroundwatcher.cpp \
+   $$PWD/../historystore.cpp \
+   $$PWD/../segmentarchive.cpp \
+   $$PWD/../sharedhistory.cpp \
+   $$PWD/../hookrunner.cpp \
+   $$PWD/../dayrollover.cpp \
+   $$PWD/../notestore.cpp \
+   $$PWD/../projects.cpp \
+   $$PWD/../stringinterner.cpp \
+   $$PWD/../settings.cpp \
+   $$PWD/../metrics.cpp \
+   $$PWD/../helpers.cpp \
+   $$PWD/../logger.cpp
+
+INCLUDEPATH = \
+    $$PWD/..
+
+TEMPLATE = app
+
+CONFIG += console testcase c++14
+CONFIG -= app_bundle
+
+QT += widgets network testlib
+
+LIBS += -lUser32
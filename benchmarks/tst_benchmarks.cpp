@@ -0,0 +1,199 @@
+#include <QtTest>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QSettings>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTime>
+#include <array>
+#include <vector>
+
+#include "settings.h"
+#include "theme.h"
+#include "contentwidget.h"
+#include "timelinewidget.h"
+#include "tracking.h"
+#include "segmentarchive.h"
+#include "helpers.h"
+#include "types.h"
+
+namespace {
+	const qint64 minute_msec = 60000;
+	const int timeline_width = 24 * 60;	// a pixel per minute
+	const qint64 tail_start_msec = 12 * 3600000;
+	const int tail_minutes = 12 * 60;
+	const int archived_days = 3 * 365;
+	const int segments_per_day = 40;
+	const qint64 archived_activity_msec = 10 * minute_msec;
+	const qint64 archived_pause_msec = 5 * minute_msec;
+}
+
+// Measures the paths whose cost the user notices. Run with e.g. -iterations 100 or -tickcounter for
+// steadier numbers. Everything is written to a temporary folder, which is also the working directory.
+class Benchmarks : public QObject
+{
+	Q_OBJECT
+
+private:
+	QTemporaryDir dir_;
+	qint64 archive_from_;
+	qint64 archive_to_;
+
+	void fillArchive();
+
+private slots:
+	void initTestCase();
+	void timeToTracking();
+	void stateSwitch();
+	void timelineTail_data();
+	void timelineTail();
+	void archiveTotals();
+	void archiveStatistics();
+};
+
+void Benchmarks::initTestCase()
+{
+	QVERIFY(dir_.isValid());
+	QVERIFY(QDir::setCurrent(dir_.path()));
+
+	QSettings ini("user-settings.ini", QSettings::IniFormat);
+	ini.setValue("uTimer/debug_log_to_file", false);
+	ini.sync();
+
+	fillArchive();
+}
+
+// Three years of working days as the segment archive stores them, a session per day
+void Benchmarks::fillArchive()
+{
+	Settings settings("user-settings.ini");
+	SegmentArchive segment_archive(settings, "archive.dat");
+	QVERIFY(segment_archive.isOpen());
+
+	const int day_start_hour = settings.getDayStartHour();
+	const QDate today = getWorkToday(day_start_hour);
+	archive_from_ = getWorkDayStartMSec(today.addDays(-archived_days), day_start_hour);
+	archive_to_ = getWorkDayStartMSec(today, day_start_hour);
+	for (int day = archived_days; day > 0; --day) {
+		qint64 t_segment = getWorkDayStartMSec(today.addDays(-day), day_start_hour) + 3 * 3600000;
+		std::vector<TimeSegment> segments;
+		for (int i = 0; i < segments_per_day; ++i) {
+			const bool activity = (i % 2 == 0);
+			const qint64 duration = activity ? archived_activity_msec : archived_pause_msec;
+			segments.push_back(TimeSegment{activity ? SegmentType::Activity : ((i % 8 == 7) ? SegmentType::Autopause : SegmentType::Pause), t_segment, duration, 0});
+			t_segment += duration;
+		}
+		segment_archive.addSession(segments);
+	}
+}
+
+// From reading the settings to a running timer, as at logon; the main window is built lazily later
+void Benchmarks::timeToTracking()
+{
+	QBENCHMARK {
+		Settings settings("user-settings.ini");
+		Tracking tracking(settings);
+		tracking.timer.start();
+		tracking.time_tracker.useTimerViaButton(Button::Start);
+		QVERIFY(tracking.time_tracker.getMode() == TimeTracker::Mode::Activity);
+	}
+}
+
+// One round through all timer states in the visible window, including the repaints they cause
+void Benchmarks::stateSwitch()
+{
+	Settings settings("user-settings.ini");
+	const Theme theme(settings);
+	ContentWidget content_widget(settings, theme);
+	content_widget.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&content_widget));
+
+	QBENCHMARK {
+		content_widget.setGUItoActivity();
+		QCoreApplication::processEvents();
+		content_widget.setGUItoPause();
+		QCoreApplication::processEvents();
+		content_widget.setGUItoStop();
+		QCoreApplication::processEvents();
+	}
+}
+
+void Benchmarks::timelineTail_data()
+{
+	QTest::addColumn<int>("segment_count");
+	QTest::newRow("10 segments") << 10;
+	QTest::newRow("1000 segments") << 1000;
+	QTest::newRow("100000 segments") << 100000;
+}
+
+// A tick of the running segment, which grows by a pixel each time, over a morning of closed segments.
+// Its cost should be the same for every number of segments.
+void Benchmarks::timelineTail()
+{
+	QFETCH(int, segment_count);
+
+	Settings settings("user-settings.ini");
+	const Theme theme(settings);
+	const QDate date = QDate::currentDate();
+	const qint64 t_day = QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch();
+	const qint64 segment_msec = tail_start_msec / segment_count;
+	std::vector<TimeSegment> segments;
+	for (int i = 0; i < segment_count; ++i)
+		segments.push_back(TimeSegment{(i % 2 == 0) ? SegmentType::Activity : SegmentType::Pause, t_day + i * segment_msec, segment_msec, 0});
+
+	TimelineWidget timeline(theme);
+	timeline.resize(timeline_width, timeline.sizeHint().height());
+	timeline.setDay(date, 0, segments);
+	timeline.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&timeline));
+	QCoreApplication::processEvents();
+
+	// At the end of the day the tail starts over as a new one, so each iteration paints something
+	int tick = 0;
+	QBENCHMARK {
+		const int minutes = 1 + tick % tail_minutes;
+		const SegmentType type = ((tick / tail_minutes) % 2 == 0) ? SegmentType::Activity : SegmentType::Pause;
+		timeline.setTail(type, t_day + tail_start_msec, t_day + tail_start_msec + minutes * minute_msec);
+		QCoreApplication::processEvents();
+		++tick;
+	}
+}
+
+// Totals over all archived years but the first and last week: the blocks fully in range are answered
+// from their headers, only the two at the edges are decoded
+void Benchmarks::archiveTotals()
+{
+	Settings settings("user-settings.ini");
+	const SegmentArchive segment_archive(settings, "archive.dat", true);
+	const qint64 from = archive_from_ + 7 * 24 * 3600000;
+	const qint64 to = archive_to_ - 7 * 24 * 3600000;
+
+	std::array<qint64, 4> totals;
+	QBENCHMARK {
+		totals = segment_archive.getTotals(from, to);
+	}
+	QCOMPARE(totals[static_cast<size_t>(SegmentType::Activity)], (archived_days - 14) * (segments_per_day / 2) * archived_activity_msec);
+}
+
+// Weekday, hour and pause length statistics need every segment of all archived years decoded
+void Benchmarks::archiveStatistics()
+{
+	Settings settings("user-settings.ini");
+	const SegmentArchive segment_archive(settings, "archive.dat", true);
+
+	SegmentStatistics statistics;
+	QBENCHMARK {
+		statistics = segment_archive.getStatistics(archive_from_, archive_to_);
+	}
+	const qint64 t_activity = archived_days * (segments_per_day / 2) * archived_activity_msec;
+	QCOMPARE(statistics.totals[static_cast<size_t>(SegmentType::Activity)], t_activity);
+	qint64 t_weekdays = 0;
+	for (const qint64 t_day : statistics.activity_per_weekday)
+		t_weekdays += t_day;
+	QCOMPARE(t_weekdays, t_activity);
+}
+
+QTEST_MAIN(Benchmarks)
+
+#include "tst_benchmarks.moc"
@@ -0,0 +1,24 @@
+#include "clock.h"
+#include <QElapsedTimer>
+#include <QDateTime>
+
+Clock::~Clock()
+{ }
+
+qint64 Clock::getMonotonicMSec() const
+{
+	QElapsedTimer now;
+	now.start();
+	return now.msecsSinceReference();
+}
+
+qint64 Clock::getWallMSec() const
+{
+	return QDateTime::currentMSecsSinceEpoch();
+}
+
+const Clock & Clock::getSystemClock()
+{
+	static const Clock system_clock;
+	return system_clock;
+}
@@ -0,0 +1,18 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <QtGlobal>
+
+// The time sources of TimeTracker: the monotonic clock durations are measured with, and the wall clock
+// start times come from. The soak test swaps in a virtual clock to run through a year in seconds.
+class Clock
+{
+public:
+	virtual ~Clock();
+	virtual qint64 getMonotonicMSec() const;	// as QElapsedTimer::msecsSinceReference()
+	virtual qint64 getWallMSec() const;			// msecs since epoch
+
+	static const Clock & getSystemClock();
+};
+
+#endif // CLOCK_H
@@ -5,17 +5,20 @@
 #include <QColor>
 #include <QStringList>
 #include <QApplication>
+#include <QSignalBlocker>
 #include "helpers.h"
 
-ContentWidget::ContentWidget(Settings & settings, QWidget *parent) : QWidget(parent), settings_(settings), button_hold_color_(QColor(180,216,228,255))
+ContentWidget::ContentWidget(Settings & settings, const Theme & theme, QWidget *parent) : QWidget(parent), settings_(settings), theme_(theme)
 {
 	setupGUI();
 
-	QObject::connect(startpause_button_, SIGNAL(clicked()), this, SLOT(pressedStartPauseButton()));
-	QObject::connect(stop_button_, SIGNAL(clicked()), this, SLOT(pressedStopButton()));
-	QObject::connect(mintotray_button_, SIGNAL(clicked()), this, SLOT(pressedMinToTrayButton()));
-	QObject::connect(pintotop_button_, SIGNAL(clicked()), this, SLOT(pressedPinToTopButton()));
-	QObject::connect(autopause_button_, SIGNAL(clicked()), this, SLOT(pressedAutoPauseButton()));
+	QObject::connect(startpause_button_, &QAbstractButton::clicked, this, &ContentWidget::pressedStartPauseButton);
+	QObject::connect(stop_button_, &QAbstractButton::clicked, this, &ContentWidget::pressedStopButton);
+	QObject::connect(mintotray_button_, &QAbstractButton::clicked, this, &ContentWidget::pressedMinToTrayButton);
+	QObject::connect(pintotop_button_, &QAbstractButton::clicked, this, &ContentWidget::pressedPinToTopButton);
+	QObject::connect(autopause_button_, &QAbstractButton::clicked, this, &ContentWidget::pressedAutoPauseButton);
+	QObject::connect(history_button_, &QAbstractButton::clicked, this, &ContentWidget::showHistory);
+	QObject::connect(project_combo_, &QComboBox::textActivated, this, &ContentWidget::switchProject);
 }
 
 void ContentWidget::setupGUI()
@@ -23,10 +26,14 @@ void ContentWidget::setupGUI()
 	rows_ = new QVBoxLayout(this);
 
 	setupTimeRows();
+	setupProjectRow();
 	setupButtonRows();
 
 	rows_->addLayout(activity_row_);
 	rows_->addLayout(pause_row_);
+	rows_->addLayout(project_row_);
+	rows_->addWidget(history_text_);
+	rows_->addWidget(timeline_);
 	rows_->addLayout(button_row_);
 	rows_->addLayout(optionbutton_row_);
 
@@ -57,6 +64,37 @@ void ContentWidget::setupTimeRows()
 	pause_time_->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
 	pause_row_->addWidget(pause_text_);
 	pause_row_->addWidget(pause_time_);
+
+	// This Week 0.00h, This Month 0.00h
+	QFont history_font = QApplication::font();
+	history_font.setPointSize(8);
+	history_text_ = new QLabel();
+	history_text_->setFont(history_font);
+	history_text_->setToolTip("Activity Time of all stopped Sessions");
+
+	// [====  ==   ====     ]
+	timeline_ = new TimelineWidget(theme_);
+	timeline_->setToolTip("Today");
+}
+
+void ContentWidget::setupProjectRow()
+{
+	QFont label_font = QApplication::font();
+	label_font.setPointSize(9);
+
+	// [Project    v]  0.00h
+	project_row_ = new QHBoxLayout();
+	project_combo_ = new QComboBox();
+	project_combo_->setFont(label_font);
+	project_combo_->setEditable(true);
+	project_combo_->setInsertPolicy(QComboBox::InsertAtBottom);
+	project_combo_->setToolTip("Project the Activity Time is counted for; type a new Name to add one");
+	project_time_ = new QLabel("0.00h");
+	project_time_->setFont(label_font);
+	project_time_->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	project_time_->setToolTip("Activity Time of this Project");
+	project_row_->addWidget(project_combo_, 1);
+	project_row_->addWidget(project_time_);
 }
 
 void ContentWidget::setupButtonRows()
@@ -75,7 +113,7 @@ void ContentWidget::setupButtonRows()
 	button_row_->addWidget(startpause_button_);
 	button_row_->addWidget(stop_button_);
 
-	// [Min to Tray] [Stay on Top] [Auto-Pause]
+	// [Min to Tray] [Stay on Top] [Auto-Pause] [History]
 	optionbutton_row_ = new QHBoxLayout();
 	mintotray_button_ = new QPushButton("Min to Tray");
 	mintotray_button_->setFont(button_font);
@@ -89,16 +127,32 @@ void ContentWidget::setupButtonRows()
 	autopause_button_->setToolTip(settings_.getBackpauseMin() + autopause_tooltip_);
 	optionbutton_row_->addWidget(mintotray_button_);
 	optionbutton_row_->addWidget(pintotop_button_);
+	history_button_ = new QPushButton("History");
+	history_button_->setFont(button_font);
+	history_button_->setToolTip("Browse all stored Days");
 	optionbutton_row_->addWidget(autopause_button_);
+	optionbutton_row_->addWidget(history_button_);
 }
 
 void ContentWidget::applyStartupSettingsToGui()
 {
-	if (settings_.isAutopauseEnabled())
-		toggleButtonColor(autopause_button_, button_hold_color_);
+	setButtonHeld(autopause_button_, settings_.isAutopauseEnabled());
+	setButtonHeld(pintotop_button_, settings_.isPinnedStartEnabled());
+	activity_time_->setPalette(theme_.getLabelPalette(false));
+	pause_time_->setPalette(theme_.getLabelPalette(false));
+}
 
-	if (settings_.isPinnedStartEnabled())
-		toggleButtonColor(pintotop_button_, button_hold_color_);
+void ContentWidget::setButtonHeld(QPushButton * const button, const bool held)
+{
+	button->setPalette(theme_.getButtonPalette(held));
+}
+
+void ContentWidget::pressButton(Button button)
+{
+	if (((button == Button::Start) && !isGUIinActivity()) || ((button == Button::Pause) && isGUIinActivity()))
+		pressedStartPauseButton();
+	else if (button == Button::Stop)
+		pressedStopButton();
 }
 
 void ContentWidget::pressedStartPauseButton()
@@ -129,22 +183,23 @@ void ContentWidget::pressedMinToTrayButton()
 
 void ContentWidget::pressedPinToTopButton()
 {
-	toggleButtonColor(pintotop_button_, button_hold_color_);
 	settings_.setPinToTopState(!settings_.isPinnedStartEnabled());
+	setButtonHeld(pintotop_button_, settings_.isPinnedStartEnabled());
 	emit toggleAlwaysOnTop();
 }
 
 void ContentWidget::pressedAutoPauseButton()
 {
-	toggleButtonColor(autopause_button_, button_hold_color_);
 	settings_.setAutopauseState(!settings_.isAutopauseEnabled());
+	setButtonHeld(autopause_button_, settings_.isAutopauseEnabled());
 	autopause_button_->setToolTip(settings_.getBackpauseMin() + autopause_tooltip_);
 }
 
 void ContentWidget::setActivityTimeTooltip(const QString &hours /* ="0.00" */)
 {
 	const QString tooltip_label = "That's " + hours + activity_time_tooltip_base_;
-	activity_time_->setToolTip(tooltip_label);
+	if (activity_time_->toolTip() != tooltip_label)
+		activity_time_->setToolTip(tooltip_label);
 }
 
 void ContentWidget::setPauseTimeTooltip()
@@ -178,42 +233,69 @@ void ContentWidget::setGUItoActivity()
 	manageTooltipsForActivity();
 
 	startpause_button_->setText("PAUSE");
-	activity_time_->setStyleSheet("QLabel {color : green; }");
-	pause_time_->setStyleSheet("QLabel { color : black; }");
+	activity_time_->setPalette(theme_.getLabelPalette(true));
+	pause_time_->setPalette(theme_.getLabelPalette(false));
 }
 
 void ContentWidget::setGUItoStop()
 {
 	startpause_button_->setText("START");
-	activity_time_->setStyleSheet("QLabel {color : black; }");
-	pause_time_->setStyleSheet("QLabel { color : black; }");
+	activity_time_->setPalette(theme_.getLabelPalette(false));
+	pause_time_->setPalette(theme_.getLabelPalette(false));
 }
 
 void ContentWidget::setGUItoPause()
 {
 	startpause_button_->setText("CONTINUE");
-	activity_time_->setStyleSheet("QLabel {color : black; }");
-	pause_time_->setStyleSheet("QLabel { color : green; }");
+	activity_time_->setPalette(theme_.getLabelPalette(false));
+	pause_time_->setPalette(theme_.getLabelPalette(true));
 }
 
 void ContentWidget::setAllTimes(const qint64 &t_active, const qint64 &t_pause)
 {
+	const QString activity = convMSecToTimeStr(t_active);
 	pause_time_->setText(convMSecToTimeStr(t_pause));
-	activity_time_->setText(convMSecToTimeStr(t_active));
-	setActivityTimeTooltip(convTimeStrToDurationStr(convMSecToTimeStr(t_active)));
+	activity_time_->setText(activity);
+	setActivityTimeTooltip(convTimeStrToDurationStr(activity));
 }
 
-QString ContentWidget::getTooltip()
+TimelineWidget * ContentWidget::getTimeline() const
 {
-	if (startpause_button_->text() == "CONTINUE")
-		return QString("µTimer:  In Pause (Overall " + pause_time_->text() + ")");
-	else if (startpause_button_->text() == "PAUSE")
-		return QString("µTimer:  In Activity (Overall " + convTimeStrToDurationStr(activity_time_->text()) + "h / " + activity_time_->text() + ")");
-	else
-		return QString("µTimer:  Timing inactive");
+	return timeline_;
+}
+
+void ContentWidget::setProjects(const QStringList &names, const QString &current)
+{
+	const QSignalBlocker blocker(project_combo_);
+	project_combo_->clear();
+	project_combo_->addItems(names);
+	project_combo_->setCurrentIndex(names.indexOf(current));
+}
+
+void ContentWidget::setProjectTime(const qint64 &t_active)
+{
+	const QString hours = convMSecToHoursStr(t_active) + "h";
+	if (project_time_->text() != hours)
+		project_time_->setText(hours);
+}
+
+void ContentWidget::setHistorySummary(const QString &summary)
+{
+	history_text_->setText(summary);
 }
 
 bool ContentWidget::isGUIinActivity()
 {
 	return (startpause_button_->text() == "PAUSE");
 }
+
+void ContentWidget::setGUItoMode(TimeTracker::Mode mode)
+{
+	// The tracker may change its mode on its own (autopause, remote control); buttons already set the GUI
+	if ((mode == TimeTracker::Mode::Activity) && (startpause_button_->text() != "PAUSE"))
+		setGUItoActivity();
+	else if ((mode == TimeTracker::Mode::Pause) && (startpause_button_->text() != "CONTINUE"))
+		setGUItoPause();
+	else if ((mode == TimeTracker::Mode::None) && (startpause_button_->text() != "START"))
+		setGUItoStop();
+}
@@ -7,7 +7,12 @@
 #include <QLabel>
 #include <QString>
 #include <QPushButton>
+#include <QComboBox>
+#include <QStringList>
 #include "settings.h"
+#include "theme.h"
+#include "timelinewidget.h"
+#include "timetracker.h"
 #include "types.h"
 
 class ContentWidget : public QWidget
@@ -16,6 +21,7 @@ class ContentWidget : public QWidget
 
 private:
 	Settings & settings_;
+	const Theme & theme_;
 
 	QVBoxLayout *rows_;
 	QHBoxLayout *activity_row_;
@@ -24,6 +30,11 @@ private:
 	QHBoxLayout *pause_row_;
 	QLabel *pause_text_;
 	QLabel *pause_time_;
+	QLabel *history_text_;
+	QHBoxLayout *project_row_;
+	QComboBox *project_combo_;
+	QLabel *project_time_;
+	TimelineWidget *timeline_;
 	QHBoxLayout *button_row_;
 	QPushButton *startpause_button_;
 	QPushButton *stop_button_;
@@ -31,31 +42,40 @@ private:
 	QPushButton *mintotray_button_;
 	QPushButton * pintotop_button_;
 	QPushButton *autopause_button_;
-	const QColor button_hold_color_;
+	QPushButton *history_button_;
 	QString autopause_tooltip_;
 	QString activity_time_tooltip_base_;	
 
 	void setupGUI();
 	void setupTimeRows();
 	void setupButtonRows();
+	void setupProjectRow();
 	void applyStartupSettingsToGui();
 	void setActivityTimeTooltip(const QString &hours = "0.00");
 	void setPauseTimeTooltip();
 	void resetPauseTimeTooltip();
 	void manageTooltipsForActivity();
+	void setButtonHeld(QPushButton * const button, const bool held);
         
 public:
-	explicit ContentWidget(Settings & settings, QWidget *parent = nullptr);
+	explicit ContentWidget(Settings & settings, const Theme & theme, QWidget *parent = nullptr);
 	void setAllTimes(const qint64 &t_active, const qint64 &t_pause);
-	QString getTooltip();
+	void setHistorySummary(const QString &summary);
+	TimelineWidget * getTimeline() const;
+	void setProjects(const QStringList &names, const QString &current);
+	void setProjectTime(const qint64 &t_active);
 	bool isGUIinActivity();
+	void setGUItoMode(TimeTracker::Mode mode);
 
 signals:
 	void minToTray();
 	void toggleAlwaysOnTop();
+	void showHistory();
+	void switchProject(const QString &name);
 	void pressedButton(Button button);
 
 public slots:
+	void pressButton(Button button);
 	void pressedStartPauseButton();
 	void pressedStopButton();
 	void pressedMinToTrayButton();
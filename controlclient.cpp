@@ -0,0 +1,46 @@
+#include "controlclient.h"
+#include <QLocalSocket>
+#include "controlprotocol.h"
+
+namespace {
+	const QString command_separator = "+";
+}
+
+QStringList groupControlCommands(const QStringList &arguments)
+{
+	QStringList commands;
+	bool new_command = true;
+	for (const QString &argument : arguments) {
+		if (argument == command_separator)
+			new_command = true;
+		else if (new_command) {
+			commands << argument;
+			new_command = false;
+		}
+		else
+			commands.last() += ' ' + argument;
+	}
+	return commands;
+}
+
+bool sendControlRequests(const QStringList &requests, QList<QByteArray> &responses, const int timeout_msec)
+{
+	QLocalSocket socket;
+	socket.connectToServer(controlServerName());
+	if (!socket.waitForConnected(timeout_msec))
+		return false;
+
+	QByteArray data;
+	for (const QString &request : requests)
+		data += request.toUtf8() + '\n';
+	socket.write(data);
+
+	responses.clear();
+	while (responses.size() < requests.size()) {
+		if (!socket.canReadLine() && !socket.waitForReadyRead(timeout_msec))
+			return false;
+		while (socket.canReadLine() && (responses.size() < requests.size()))
+			responses.append(socket.readLine().trimmed());
+	}
+	return true;
+}
@@ -0,0 +1,18 @@
+#ifndef CONTROLCLIENT_H
+#define CONTROLCLIENT_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Client side of the control protocol, shared by utimerctl and a second uTimer instance
+
+// The first argument names the command and all others up to a "+" are its arguments, so that an
+// argument like a note text is never taken for a command; "+" starts the next request
+QStringList groupControlCommands(const QStringList &arguments);
+
+// Sends all requests at once and collects one response line per request; false if no uTimer answers in time
+bool sendControlRequests(const QStringList &requests, QList<QByteArray> &responses, const int timeout_msec = 1000);
+
+#endif // CONTROLCLIENT_H
@@ -0,0 +1,23 @@
+#ifndef CONTROLPROTOCOL_H
+#define CONTROLPROTOCOL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QtGlobal>
+
+// Line based protocol on a local socket: every request is one line ("status", "start", "pause", "stop"),
+// every response is one line starting with "OK" or "ERR". Requests may be pipelined, responses keep their order.
+// "status", "start", "pause", "stop", "show" and "quit" answer "ERR" if they get any arguments.
+// "status" answers with "OK <activity|pause|stopped> <activity msec> <pause msec> <segment start msec since epoch> <project>".
+// "project <name>" switches to that project, creating it if needed. "show" brings up the window.
+// "quit" stops the timer and ends the running instance, e.g. a headless one started without a console.
+// "edit <hh:mm> <hh:mm> <activity|pause|delete>" corrects that range of today in the running session.
+// "note <text>" notes the current segment of the running session. "search <words>" answers with
+// "OK <count>" followed by "<tab><yyyy-MM-dd hh:mm> <note>" for each note containing all words, newest first.
+
+inline QString controlServerName()
+{
+	return ("uTimer-" + QString::fromLocal8Bit(qgetenv("USERNAME")));
+}
+
+#endif // CONTROLPROTOCOL_H
@@ -0,0 +1,157 @@
+#include "controlserver.h"
+#include <QLocalSocket>
+#include <QList>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include "controlprotocol.h"
+#include "helpers.h"
+#include "logger.h"
+#include "metrics.h"
+
+namespace {
+	const qint64 max_request_length = 1024;
+	const size_t max_search_results = 20;
+	const QList<QByteArray> commands_without_arguments = {"status", "start", "pause", "stop", "show", "quit"};
+}
+
+ControlServer::ControlServer(const Settings &settings, const TimeTracker &time_tracker, NoteStore &note_store, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		time_tracker_(time_tracker),
+		note_store_(note_store)
+{
+	server_.setSocketOptions(QLocalServer::UserAccessOption);
+	QObject::connect(&server_, &QLocalServer::newConnection, this, &ControlServer::acceptConnections);
+
+	if (!server_.listen(controlServerName()) && settings_.logToFile())
+		Logger::Log("[CONTROL] Could not open Control Socket: " + server_.errorString());
+}
+
+void ControlServer::acceptConnections()
+{
+	while (QLocalSocket *socket = server_.nextPendingConnection()) {
+		QObject::connect(socket, &QIODevice::readyRead, this, &ControlServer::processRequests);
+		QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+	}
+}
+
+void ControlServer::processRequests()
+{
+	QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+	if (socket == nullptr)
+		return;
+
+	// All complete requests that arrived together are answered with a single write
+	QByteArray responses;
+	while (socket->canReadLine())
+		responses += handleRequest(socket->readLine().trimmed()) + '\n';
+
+	if (socket->bytesAvailable() > max_request_length) {
+		socket->abort();
+		return;
+	}
+
+	if (!responses.isEmpty()) {
+		socket->write(responses);
+		socket->flush(); // a "quit" may end the event loop before the socket gets to write
+	}
+}
+
+QByteArray ControlServer::handleRequest(const QByteArray &request)
+{
+	Metrics::count(Metrics::Counter::ControlRequests);
+	const QList<QByteArray> words = request.simplified().split(' ');
+	const QByteArray &command = words.first();
+
+	// Extra words are most likely a mistyped argument of another command and must not trigger this one
+	if ((words.size() > 1) && commands_without_arguments.contains(command))
+		return "ERR usage: " + command + " takes no arguments";
+
+	if (command == "status")
+		return getStatus();
+	else if (command == "start")
+		emit sendButtons(Button::Start);
+	else if (command == "pause")
+		emit sendButtons(Button::Pause);
+	else if (command == "stop")
+		emit sendButtons(Button::Stop);
+	else if (command == "edit")
+		return handleEdit(words);
+	else if (command == "show")
+		emit showRequested();
+	else if (command == "quit")
+		emit quitRequested();
+	else if ((command == "project") && (words.size() > 1))
+		emit sendProject(QString::fromUtf8(request.simplified().mid(command.size() + 1)));
+	else if ((command == "search") && (words.size() > 1))
+		return handleSearch(QString::fromUtf8(request.simplified().mid(command.size() + 1)));
+	else if ((command == "note") && (words.size() > 1)) {
+		if (time_tracker_.getMode() == TimeTracker::Mode::None)
+			return "ERR timer not running";
+		if (!note_store_.setNote(QDateTime::currentMSecsSinceEpoch(), QString::fromUtf8(request.simplified().mid(command.size() + 1))))
+			return "ERR could not store note";
+	}
+	else
+		return "ERR unknown command";
+
+	if (settings_.logToFile())
+		Logger::Log("[CONTROL] Received Command '" + QString::fromUtf8(command) + "'");
+	return "OK";
+}
+
+QByteArray ControlServer::handleEdit(const QList<QByteArray> &words)
+{
+	if (words.size() != 4)
+		return "ERR usage: edit <hh:mm> <hh:mm> <activity|pause|delete>";
+	if (time_tracker_.getMode() == TimeTracker::Mode::None)
+		return "ERR timer not running";
+
+	const QTime from = QTime::fromString(QString::fromUtf8(words[1]), "hh:mm");
+	const QTime to = QTime::fromString(QString::fromUtf8(words[2]), "hh:mm");
+	if (!from.isValid() || !to.isValid() || (from >= to))
+		return "ERR invalid range";
+
+	SegmentEdit edit;
+	if (words[3] == "activity")
+		edit = SegmentEdit::Activity;
+	else if (words[3] == "pause")
+		edit = SegmentEdit::Pause;
+	else if (words[3] == "delete")
+		edit = SegmentEdit::Delete;
+	else
+		return "ERR unknown segment type";
+
+	const int day_start_hour = settings_.getDayStartHour();
+	const QDate today = getWorkToday(day_start_hour);
+	emit sendEdit(convWorkTimeToMSec(today, from, day_start_hour), convWorkTimeToMSec(today, to, day_start_hour), edit);
+	if (settings_.logToFile())
+		Logger::Log("[CONTROL] Received Command 'edit'");
+	return "OK";
+}
+
+QByteArray ControlServer::handleSearch(const QString &query)
+{
+	const std::vector<NoteStore::Note> notes = note_store_.search(query, max_search_results);
+	QByteArray response = "OK " + QByteArray::number(static_cast<qulonglong>(notes.size()));
+	for (const NoteStore::Note &note : notes)
+		response += '\t' + QDateTime::fromMSecsSinceEpoch(note.time).toString("yyyy-MM-dd hh:mm").toUtf8() + ' ' + note.text.toUtf8();
+	if (settings_.logToFile())
+		Logger::Log("[CONTROL] Received Command 'search'");
+	return response;
+}
+
+QByteArray ControlServer::getStatus() const
+{
+	QByteArray mode = "stopped";
+	if (time_tracker_.getMode() == TimeTracker::Mode::Activity)
+		mode = "activity";
+	else if (time_tracker_.getMode() == TimeTracker::Mode::Pause)
+		mode = "pause";
+
+	return ("OK " + mode
+					+ ' ' + QByteArray::number(time_tracker_.getActiveTime())
+					+ ' ' + QByteArray::number(time_tracker_.getPauseTime())
+					+ ' ' + QByteArray::number(time_tracker_.getSegmentStart())
+					+ ' ' + time_tracker_.getProjectName().toUtf8());
+}
@@ -0,0 +1,45 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "settings.h"
+#include "timetracker.h"
+#include "notestore.h"
+#include "types.h"
+
+
+class ControlServer : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	const TimeTracker & time_tracker_;
+	NoteStore & note_store_;
+	QLocalServer server_;
+
+	QByteArray handleRequest(const QByteArray &request);
+	QByteArray getStatus() const;
+	QByteArray handleEdit(const QList<QByteArray> &words);
+	QByteArray handleSearch(const QString &query);
+
+private slots:
+	void acceptConnections();
+	void processRequests();
+
+public:
+	explicit ControlServer(const Settings & settings, const TimeTracker & time_tracker, NoteStore & note_store, QObject *parent = nullptr);
+
+signals:
+	void sendButtons(Button button);
+	void sendEdit(qint64 from, qint64 to, SegmentEdit edit);
+	void sendProject(const QString &name);
+	void showRequested();
+	void quitRequested();
+};
+
+#endif // CONTROLSERVER_H
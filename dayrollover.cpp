@@ -0,0 +1,98 @@
+#include "dayrollover.h"
+#include <QDateTime>
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	const qint64 early_tolerance_msec = 1000;
+	const wchar_t clock_window_class[] = L"uTimerClockWindow";
+}
+
+DayRollover::DayRollover(const Settings &settings, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		t_deadline_(0),
+		window_(nullptr)
+{
+	deadline_timer_.setSingleShot(true);
+	deadline_timer_.setTimerType(Qt::PreciseTimer);
+	QObject::connect(&deadline_timer_, &QTimer::timeout, this, &DayRollover::reactOnDeadline);
+
+	createClockWindow();
+	armAfter(QDateTime::currentMSecsSinceEpoch());
+}
+
+DayRollover::~DayRollover()
+{
+	if (window_ != nullptr)
+		DestroyWindow(window_);
+}
+
+qint64 DayRollover::getDeadline() const
+{
+	return t_deadline_;
+}
+
+void DayRollover::createClockWindow()
+{
+	const HINSTANCE instance = GetModuleHandleW(nullptr);
+	WNDCLASSW window_class = {};
+	window_class.lpfnWndProc = windowProc;
+	window_class.hInstance = instance;
+	window_class.lpszClassName = clock_window_class;
+	RegisterClassW(&window_class);
+
+	// Never shown; message-only windows would not get the broadcast
+	window_ = CreateWindowExW(0, clock_window_class, L"", WS_POPUP, 0, 0, 0, 0, nullptr, nullptr, instance, nullptr);
+	if (window_ == nullptr) {
+		if (settings_.logToFile())
+			Logger::Log("[DAY] Could not create Window for Clock Changes, Day Start is only re-armed after Sleep");
+		return;
+	}
+	SetWindowLongPtrW(window_, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+}
+
+LRESULT CALLBACK DayRollover::windowProc(HWND window, UINT message, WPARAM w_param, LPARAM l_param)
+{
+	if (message == WM_TIMECHANGE) {
+		DayRollover *rollover = reinterpret_cast<DayRollover*>(GetWindowLongPtrW(window, GWLP_USERDATA));
+		if (rollover != nullptr)
+			QMetaObject::invokeMethod(rollover, "rearm", Qt::QueuedConnection);
+		return 0;
+	}
+	return DefWindowProcW(window, message, w_param, l_param);
+}
+
+void DayRollover::armAfter(const qint64 t_from)
+{
+	// The next day start is taken from the local calendar, so days of 23 or 25 hours just work
+	const int day_start_hour = settings_.getDayStartHour();
+	t_deadline_ = getWorkDayStartMSec(getWorkDate(t_from, day_start_hour).addDays(1), day_start_hour);
+	const qint64 t_remaining = qMax(Q_INT64_C(0), t_deadline_ - QDateTime::currentMSecsSinceEpoch());
+	deadline_timer_.start(static_cast<int>(t_remaining));
+	if (settings_.logToFile())
+		Logger::Log("[DAY] Next Day starts " + QDateTime::fromMSecsSinceEpoch(t_deadline_).toString(Qt::ISODate));
+}
+
+void DayRollover::rearm()
+{
+	// A deadline that passed while asleep or by a clock change still ends the day, late
+	if (QDateTime::currentMSecsSinceEpoch() >= t_deadline_)
+		reactOnDeadline();
+	else
+		armAfter(QDateTime::currentMSecsSinceEpoch());
+}
+
+void DayRollover::reactOnDeadline()
+{
+	const qint64 t_now = QDateTime::currentMSecsSinceEpoch();
+	if (t_now < t_deadline_ - early_tolerance_msec) {
+		armAfter(t_now);
+		return;
+	}
+
+	if (settings_.logToFile())
+		Logger::Log("[DAY] >> New Day started");
+	emit dayStarted();
+	armAfter(qMax(t_now, t_deadline_));
+}
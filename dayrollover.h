@@ -0,0 +1,42 @@
+#ifndef DAYROLLOVER_H
+#define DAYROLLOVER_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QTimer>
+#include <Windows.h>
+#include "settings.h"
+
+// Signals the start of a new work day at the configured hour. A single one-shot timer is armed
+// for the next day start; it is re-armed after a system sleep and when Windows reports a changed
+// clock or time zone (WM_TIMECHANGE, only broadcast to top-level windows, hence the hidden window).
+class DayRollover : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QTimer deadline_timer_;
+	qint64 t_deadline_;	// msec since epoch
+	HWND window_;
+
+	void armAfter(const qint64 t_from);
+	void createClockWindow();
+	static LRESULT CALLBACK windowProc(HWND window, UINT message, WPARAM w_param, LPARAM l_param);
+
+private slots:
+	void reactOnDeadline();
+
+public:
+	explicit DayRollover(const Settings & settings, QObject *parent = nullptr);
+	~DayRollover();
+	qint64 getDeadline() const;
+
+signals:
+	void dayStarted();
+
+public slots:
+	void rearm();
+};
+
+#endif // DAYROLLOVER_H
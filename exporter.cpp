@@ -0,0 +1,177 @@
+#include "exporter.h"
+#include <QDateTime>
+#include <QFile>
+
+namespace {
+	const int buffer_capacity = 64 * 1024;
+
+	QByteArray getTypeName(const SegmentType type)
+	{
+		switch (type) {
+			case SegmentType::Activity: return "activity";
+			case SegmentType::Pause: return "pause";
+			case SegmentType::Autopause: return "autopause";
+			case SegmentType::Sleep: return "sleep";
+		}
+		return "unknown";
+	}
+
+	QByteArray toLocalTimeStr(const qint64 msecs)
+	{
+		return QDateTime::fromMSecsSinceEpoch(msecs).toString(Qt::ISODate).toUtf8();
+	}
+
+	QByteArray escapeCsv(const QString &text)
+	{
+		QByteArray escaped = text.toUtf8();
+		if (escaped.contains(',') || escaped.contains('"'))
+			escaped = '"' + escaped.replace("\"", "\"\"") + '"';
+		return escaped;
+	}
+
+	QByteArray escapeJson(const QString &text)
+	{
+		return text.toUtf8().replace("\\", "\\\\").replace("\"", "\\\"");
+	}
+
+	QByteArray escapeICal(const QString &text)
+	{
+		return text.toUtf8().replace("\\", "\\\\").replace(",", "\\,").replace(";", "\\;");
+	}
+
+	QByteArray toICalTimeStr(const qint64 msecs)
+	{
+		return QDateTime::fromMSecsSinceEpoch(msecs).toUTC().toString("yyyyMMdd'T'HHmmss'Z'").toUtf8();
+	}
+}
+
+Exporter::Exporter(QIODevice &device, const ExportFormat format, const Projects &projects)
+	: device_(device),
+		format_(format),
+		projects_(projects),
+		ok_(true)
+{
+	buffer_.reserve(buffer_capacity);
+}
+
+bool Exporter::parseFormat(const QString &name, ExportFormat &format)
+{
+	if (name == "csv")
+		format = ExportFormat::Csv;
+	else if ((name == "jsonl") || (name == "json"))
+		format = ExportFormat::JsonLines;
+	else if (name == "ics")
+		format = ExportFormat::ICalendar;
+	else
+		return false;
+	return true;
+}
+
+void Exporter::write(const QByteArray &text)
+{
+	buffer_.append(text);
+	if (buffer_.size() >= buffer_capacity)
+		flush();
+}
+
+void Exporter::flush()
+{
+	if (ok_ && !buffer_.isEmpty())
+		ok_ = (device_.write(buffer_) == buffer_.size());
+	buffer_.clear();
+}
+
+void Exporter::writeSegmentHeader()
+{
+	if (format_ == ExportFormat::Csv)
+		write("start,end,duration_msec,type,project\r\n");
+	else if (format_ == ExportFormat::ICalendar)
+		write("BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//uTimer//Segments//EN\r\n");
+}
+
+void Exporter::writeDayHeader()
+{
+	if (format_ == ExportFormat::Csv)
+		write("date,activity_msec,pause_msec,first_start,last_stop,autopauses,sessions\r\n");
+	else if (format_ == ExportFormat::ICalendar)
+		write("BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//uTimer//Days//EN\r\n");
+}
+
+void Exporter::writeFooter()
+{
+	if (format_ == ExportFormat::ICalendar)
+		write("END:VCALENDAR\r\n");
+	flush();
+}
+
+void Exporter::writeSegment(const qint64 start, const qint64 duration, const SegmentType type, const quint16 project)
+{
+	const QByteArray type_name = getTypeName(type);
+	const QString project_name = projects_.getName(project);
+	if (format_ == ExportFormat::Csv) {
+		write(toLocalTimeStr(start) + ',' + toLocalTimeStr(start + duration) + ',' + QByteArray::number(duration) + ',' + type_name + ',' + escapeCsv(project_name) + "\r\n");
+	}
+	else if (format_ == ExportFormat::JsonLines) {
+		write("{\"start\":\"" + toLocalTimeStr(start) + "\",\"end\":\"" + toLocalTimeStr(start + duration)
+					+ "\",\"duration_msec\":" + QByteArray::number(duration) + ",\"type\":\"" + type_name + "\",\"project\":\"" + escapeJson(project_name) + "\"}\n");
+	}
+	else if (format_ == ExportFormat::ICalendar) {
+		write("BEGIN:VEVENT\r\nUID:" + QByteArray::number(start) + '-' + type_name + "@utimer\r\nDTSTAMP:" + toICalTimeStr(start)
+					+ "\r\nDTSTART:" + toICalTimeStr(start) + "\r\nDTEND:" + toICalTimeStr(start + duration)
+					+ "\r\nSUMMARY:" + type_name + ' ' + escapeICal(project_name) + "\r\nEND:VEVENT\r\n");
+	}
+}
+
+void Exporter::writeDay(const QDate &date, const DayRecord &record)
+{
+	const QByteArray date_str = date.toString(Qt::ISODate).toUtf8();
+	if (format_ == ExportFormat::Csv) {
+		write(date_str + ',' + QByteArray::number(record.activity) + ',' + QByteArray::number(record.pause) + ','
+					+ toLocalTimeStr(record.first_start) + ',' + toLocalTimeStr(record.last_stop) + ','
+					+ QByteArray::number(record.autopauses) + ',' + QByteArray::number(record.sessions) + "\r\n");
+	}
+	else if (format_ == ExportFormat::JsonLines) {
+		write("{\"date\":\"" + date_str + "\",\"activity_msec\":" + QByteArray::number(record.activity) + ",\"pause_msec\":" + QByteArray::number(record.pause)
+					+ ",\"first_start\":\"" + toLocalTimeStr(record.first_start) + "\",\"last_stop\":\"" + toLocalTimeStr(record.last_stop)
+					+ "\",\"autopauses\":" + QByteArray::number(record.autopauses) + ",\"sessions\":" + QByteArray::number(record.sessions) + "}\n");
+	}
+	else if (format_ == ExportFormat::ICalendar) {
+		const QByteArray day = date.toString("yyyyMMdd").toUtf8();
+		write("BEGIN:VEVENT\r\nUID:" + day + "@utimer\r\nDTSTAMP:" + toICalTimeStr(record.last_stop)
+					+ "\r\nDTSTART;VALUE=DATE:" + day + "\r\nDTEND;VALUE=DATE:" + date.addDays(1).toString("yyyyMMdd").toUtf8()
+					+ "\r\nSUMMARY:Activity " + QByteArray::number(static_cast<double>(record.activity) / 3600000.0, 'f', 2) + "h\r\nEND:VEVENT\r\n");
+	}
+}
+
+bool Exporter::exportSegments(const SegmentArchive &segment_archive, const qint64 from, const qint64 to)
+{
+	QFile file(segment_archive.getFileName());
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	writeSegmentHeader();
+	SegmentColumns columns;
+	for (const SegmentBlock &block : segment_archive.getBlocks()) {
+		if ((block.max_start < from) || (block.min_start >= to))
+			continue;
+		if (!SegmentArchive::readBlock(file, block, columns))
+			return false;
+		for (size_t i = 0; ok_ && (i < columns.size()); ++i)
+			if ((columns.starts[i] >= from) && (columns.starts[i] < to))
+				writeSegment(columns.starts[i], columns.durations[i], static_cast<SegmentType>(columns.types[i]), columns.projects[i]);
+	}
+	writeFooter();
+	return ok_;
+}
+
+bool Exporter::exportDays(const HistoryStore &history_store, const QDate &first, const QDate &last)
+{
+	writeDayHeader();
+	for (QDate date = first; ok_ && (date <= last); date = date.addDays(1)) {
+		const DayRecord record = history_store.getDay(date);
+		if (record.sessions > 0)
+			writeDay(date, record);
+	}
+	writeFooter();
+	return ok_;
+}
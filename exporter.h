@@ -0,0 +1,43 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QDate>
+#include <QIODevice>
+#include <QString>
+#include "segmentarchive.h"
+#include "historystore.h"
+#include "projects.h"
+#include "types.h"
+
+enum class ExportFormat {Csv, JsonLines, ICalendar};
+
+// Streams archived segments or day records into a device. Only one decoded archive block and one output
+// buffer are held at any time, so memory stays constant however long the history is.
+class Exporter
+{
+private:
+	QIODevice & device_;
+	const ExportFormat format_;
+	const Projects & projects_;
+	QByteArray buffer_;
+	bool ok_;
+
+	void write(const QByteArray &text);
+	void flush();
+	void writeSegmentHeader();
+	void writeDayHeader();
+	void writeFooter();
+	void writeSegment(const qint64 start, const qint64 duration, const SegmentType type, const quint16 project);
+	void writeDay(const QDate &date, const DayRecord &record);
+
+public:
+	explicit Exporter(QIODevice & device, const ExportFormat format, const Projects & projects);
+	bool exportSegments(const SegmentArchive &segment_archive, const qint64 from, const qint64 to);
+	bool exportDays(const HistoryStore &history_store, const QDate &first, const QDate &last);
+
+	static bool parseFormat(const QString &name, ExportFormat &format);
+};
+
+#endif // EXPORTER_H
@@ -0,0 +1,165 @@
+#include "foregroundwatcher.h"
+#include <QFileInfo>
+#include <QDateTime>
+#include <QStringList>
+#include <algorithm>
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	// WinEvent callbacks carry no context, and there is only one watcher
+	ForegroundWatcher *watcher_instance = nullptr;
+	const int max_app_name_length = 64;
+	const size_t logged_app_count = 10;
+}
+
+ForegroundWatcher::ForegroundWatcher(const Settings &settings, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		hook_(nullptr),
+		app_(0),
+		has_app_(false),
+		mode_(TimeTracker::Mode::None)
+{
+	if (!settings_.isForegroundTrackingEnabled())
+		return;
+
+	watcher_instance = this;
+
+	// Out of context, the callback runs on this thread from its message loop, i.e. the Qt event loop
+	hook_ = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, &ForegroundWatcher::winEventCallback, 0, 0, WINEVENT_OUTOFCONTEXT);
+	if (hook_ == nullptr) {
+		watcher_instance = nullptr;
+		if (settings_.logToFile())
+			Logger::Log("[APPS] Could not watch the Foreground Window");
+		return;
+	}
+	registerForeground(GetForegroundWindow());
+}
+
+ForegroundWatcher::~ForegroundWatcher()
+{
+	if (hook_ != nullptr)
+		UnhookWinEvent(hook_);
+	if (watcher_instance == this)
+		watcher_instance = nullptr;
+}
+
+void CALLBACK ForegroundWatcher::winEventCallback(HWINEVENTHOOK /* hook */, DWORD event, HWND window, LONG id_object, LONG /* id_child */, DWORD /* thread */, DWORD /* time */)
+{
+	if ((watcher_instance != nullptr) && (event == EVENT_SYSTEM_FOREGROUND) && (id_object == OBJID_WINDOW))
+		watcher_instance->registerForeground(window);
+}
+
+QString ForegroundWatcher::getAppName(HWND window)
+{
+	if (window == nullptr)
+		return QString();
+
+	QString name;
+	DWORD process_id = 0;
+	GetWindowThreadProcessId(window, &process_id);
+	HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, process_id);
+	if (process != nullptr) {
+		wchar_t path[MAX_PATH];
+		DWORD size = MAX_PATH;
+		if (QueryFullProcessImageNameW(process, 0, path, &size))
+			name = QFileInfo(QString::fromWCharArray(path, static_cast<int>(size))).fileName();
+		CloseHandle(process);
+	}
+
+	// Elevated processes can't be queried, their window class is the next best name
+	if (name.isEmpty()) {
+		wchar_t class_name[256];
+		const int length = GetClassNameW(window, class_name, 256);
+		if (length > 0)
+			name = QString::fromWCharArray(class_name, length);
+	}
+	return name.left(max_app_name_length);
+}
+
+void ForegroundWatcher::addSwitch()
+{
+	if ((mode_ != TimeTracker::Mode::None) && has_app_)
+		switches_.push_back(ForegroundSwitch{QDateTime::currentMSecsSinceEpoch(), app_});
+}
+
+void ForegroundWatcher::registerForeground(HWND window)
+{
+	registerApp(getAppName(window));
+}
+
+void ForegroundWatcher::registerApp(const QString &name)
+{
+	quint16 app = 0;
+	if (name.isEmpty() || !apps_.intern(name, app) || (has_app_ && (app == app_)))
+		return;
+
+	if (app >= app_totals_.size())
+		app_totals_.resize(app + 1, 0);
+
+	app_ = app;
+	has_app_ = true;
+	addSwitch();
+}
+
+void ForegroundWatcher::reactOnModeChange(TimeTracker::Mode mode)
+{
+	if (hook_ == nullptr)
+		return;
+
+	const TimeTracker::Mode previous_mode = mode_;
+	mode_ = mode;
+
+	// Like the timer totals, a new session starts from zero, with the app that is in front
+	if ((previous_mode == TimeTracker::Mode::None) && (mode != TimeTracker::Mode::None)) {
+		switches_.clear();
+		addSwitch();
+	}
+}
+
+void ForegroundWatcher::addSession(const std::vector<TimeSegment> &segments)
+{
+	if (hook_ == nullptr)
+		return;
+
+	// Both are ordered by time, so one sweep over the switches covers all Activity segments
+	std::fill(app_totals_.begin(), app_totals_.end(), 0);
+	size_t index = 0;
+	for (const TimeSegment &segment : segments)
+		if (segment.type == SegmentType::Activity)
+			addActivity(segment.start, segment.start + segment.duration, index);
+	logTotals();
+	switches_.clear();
+}
+
+void ForegroundWatcher::addActivity(const qint64 from, const qint64 to, size_t &index)
+{
+	// index is the last switch at or before from, or the first one if none is
+	while ((index + 1 < switches_.size()) && (switches_[index + 1].start <= from))
+		++index;
+
+	for (size_t i = index; (i < switches_.size()) && (switches_[i].start < to); ++i) {
+		const qint64 start = qMax(from, switches_[i].start);
+		const qint64 end = (i + 1 < switches_.size()) ? qMin(to, switches_[i + 1].start) : to;
+		if (end > start)
+			app_totals_[switches_[i].app] += end - start;
+	}
+}
+
+void ForegroundWatcher::logTotals() const
+{
+	if (!settings_.logToFile())
+		return;
+
+	std::vector<quint16> apps;
+	for (size_t app = 0; app < app_totals_.size(); ++app)
+		if (app_totals_[app] > 0)
+			apps.push_back(static_cast<quint16>(app));
+	std::sort(apps.begin(), apps.end(), [this](const quint16 a, const quint16 b) { return app_totals_[a] > app_totals_[b]; });
+
+	QStringList entries;
+	for (size_t i = 0; (i < apps.size()) && (i < logged_app_count); ++i)
+		entries << apps_.getString(apps[i]) + " " + convMSecToHoursStr(app_totals_[apps[i]]) + "h";
+	Logger::Log("[APPS] Activity per Application (" + QString::number(switches_.size()) + " Switches): " + entries.join(", "));
+}
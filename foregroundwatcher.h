@@ -0,0 +1,56 @@
+#ifndef FOREGROUNDWATCHER_H
+#define FOREGROUNDWATCHER_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QString>
+#include <vector>
+#include <Windows.h>
+#include "settings.h"
+#include "stringinterner.h"
+#include "timetracker.h"
+#include "types.h"
+
+struct ForegroundSwitch
+{
+	qint64 start;	// msecs since epoch, like segment starts
+	quint16 app;
+};
+
+// Which application is in the foreground during Activity time. Windows reports every foreground
+// change by event, so nothing is polled. Applications are interned, and during a session each switch
+// is kept as its time and the app id. When the session stops, the switches are laid over its final
+// segments, so backpauses and edits are followed, and the Activity time per application is logged.
+class ForegroundWatcher : public QObject
+{
+	Q_OBJECT
+	friend class SoakTest;
+
+private:
+	const Settings & settings_;
+	HWINEVENTHOOK hook_;
+	StringInterner apps_;
+	std::vector<ForegroundSwitch> switches_;	// of the running session, by time
+	std::vector<qint64> app_totals_;	// Activity msec, by app id
+	quint16 app_;
+	bool has_app_;
+	TimeTracker::Mode mode_;
+
+	void addSwitch();
+	void addActivity(const qint64 from, const qint64 to, size_t &index);
+	void registerForeground(HWND window);
+	void registerApp(const QString &name);
+	void logTotals() const;
+	static QString getAppName(HWND window);
+	static void CALLBACK winEventCallback(HWINEVENTHOOK hook, DWORD event, HWND window, LONG id_object, LONG id_child, DWORD thread, DWORD time);
+
+public:
+	explicit ForegroundWatcher(const Settings & settings, QObject *parent = nullptr);
+	~ForegroundWatcher();
+
+public slots:
+	void reactOnModeChange(TimeTracker::Mode mode);
+	void addSession(const std::vector<TimeSegment> &segments);
+};
+
+#endif // FOREGROUNDWATCHER_H
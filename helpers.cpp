@@ -1,4 +1,5 @@
 #include "helpers.h"
+#include <QStringList>
 
 
 
@@ -9,16 +10,14 @@ qint64 convMinToMsec(const int &minutes)
 
 QString convMSecToTimeStr(const qint64 &time)
 {
-	return (QDateTime::fromTime_t(static_cast<unsigned int>(time/1000)).toUTC().toString("hh:mm:ss"));
+	// Not a time of day: sessions left running overnight go beyond 24 hours
+	const qint64 seconds = qMax(Q_INT64_C(0), time / 1000);
+	return (QString::number(seconds / 3600).rightJustified(2, '0') + ":" + QString::number((seconds / 60) % 60).rightJustified(2, '0') + ":" + QString::number(seconds % 60).rightJustified(2, '0'));
 }
 
-void toggleButtonColor(QPushButton * const button, const QColor &color)
+QString convMSecToHoursStr(const qint64 &time)
 {
-	const QString stylesheet_string = QString("QPushButton {background-color: %1;}").arg(color.name());
-	if (button->styleSheet() != stylesheet_string)
-		button->setStyleSheet(stylesheet_string);
-	else
-		button->setStyleSheet("");
+	return QString::number(static_cast<double>(time) / 3600000.0, 'f', 2);
 }
 
 QString convMinAndSecToHourPctString(const int min, const int sec)
@@ -33,3 +32,60 @@ QString convTimeStrToDurationStr(const QString &time_str)
 	QString hour_frac = convMinAndSecToHourPctString(split[1].toInt(), split[2].toInt());
 	return (hours + "." + hour_frac);
 }
+
+QString getTransitionName(const Transition transition)
+{
+	switch (transition) {
+	case Transition::Start: return "start";
+	case Transition::Pause: return "pause";
+	case Transition::Autopause: return "autopause";
+	case Transition::Unpause: return "unpause";
+	case Transition::Stop: return "stop";
+	case Transition::Warning: return "warning";
+	}
+	return QString();
+}
+
+void putVarint(QByteArray &out, quint64 value)
+{
+	while (value >= 0x80) {
+		out.append(static_cast<char>((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.append(static_cast<char>(value));
+}
+
+bool getVarint(const uchar *&pos, const uchar * const end, quint64 &value)
+{
+	value = 0;
+	for (int shift = 0; (pos < end) && (shift < 64); shift += 7) {
+		const uchar byte = *pos++;
+		value |= static_cast<quint64>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+QDate getWorkDate(const qint64 &msecs, const int day_start_hour)
+{
+	// Taken from the local time of day rather than by shifting msecs, so DST days still start at the hour
+	const QDateTime local = QDateTime::fromMSecsSinceEpoch(msecs);
+	return ((local.time().hour() < day_start_hour) ? local.date().addDays(-1) : local.date());
+}
+
+QDate getWorkToday(const int day_start_hour)
+{
+	return getWorkDate(QDateTime::currentMSecsSinceEpoch(), day_start_hour);
+}
+
+qint64 getWorkDayStartMSec(const QDate &work_date, const int day_start_hour)
+{
+	return QDateTime(work_date, QTime(day_start_hour, 0)).toMSecsSinceEpoch();
+}
+
+qint64 convWorkTimeToMSec(const QDate &work_date, const QTime &time, const int day_start_hour)
+{
+	// Times before the day start belong to the night after the work date
+	return QDateTime((time.hour() < day_start_hour) ? work_date.addDays(1) : work_date, time).toMSecsSinceEpoch();
+}
@@ -3,19 +3,35 @@
 
 #include <QtGlobal>
 #include <QString>
+#include <QByteArray>
+#include <QDate>
 #include <QDateTime>
-#include <QPushButton>
-#include <QColor>
+#include <QTime>
+#include "types.h"
 
 
 qint64 convMinToMsec(const int &minutes);
 
 QString convMSecToTimeStr(const qint64 &time);
 
-void toggleButtonColor(QPushButton * const button, const QColor &color);
+QString convMSecToHoursStr(const qint64 &time);
 
 QString convMinAndSecToHourPctString(const int min, const int sec);
 
 QString convTimeStrToDurationStr(const QString &time_str);
 
+QString getTransitionName(const Transition transition);
+
+void putVarint(QByteArray &out, quint64 value);
+
+bool getVarint(const uchar *&pos, const uchar * const end, quint64 &value);
+
+QDate getWorkDate(const qint64 &msecs, const int day_start_hour);
+
+QDate getWorkToday(const int day_start_hour);
+
+qint64 getWorkDayStartMSec(const QDate &work_date, const int day_start_hour);
+
+qint64 convWorkTimeToMSec(const QDate &work_date, const QTime &time, const int day_start_hour);
+
 #endif // HELPERS
@@ -0,0 +1,161 @@
+#include "historymodel.h"
+#include <QDateTime>
+#include <algorithm>
+#include <map>
+#include "helpers.h"
+
+namespace {
+	const size_t fetch_batch_size = 100;
+}
+
+HistoryModel::HistoryModel(const HistoryStore &history_store, QObject *parent)
+	: QAbstractTableModel(parent),
+		history_store_(history_store)
+{
+	reload();
+}
+
+void HistoryModel::reload()
+{
+	beginResetModel();
+	days_.clear();
+	next_day_ = history_store_.getToday().toJulianDay();
+	const QDate first_date = history_store_.getFirstDate();
+	first_day_ = first_date.isValid() ? first_date.toJulianDay() : (next_day_ + 1);
+	endResetModel();
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const
+{
+	return (parent.isValid() ? 0 : static_cast<int>(days_.size()));
+}
+
+int HistoryModel::columnCount(const QModelIndex &parent) const
+{
+	return (parent.isValid() ? 0 : ColumnCount);
+}
+
+bool HistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+	return (!parent.isValid() && (next_day_ >= first_day_));
+}
+
+void HistoryModel::fetchMore(const QModelIndex &parent)
+{
+	if (parent.isValid())
+		return;
+
+	std::vector<qint64> fetched;
+	while ((fetched.size() < fetch_batch_size) && (next_day_ >= first_day_)) {
+		if (history_store_.getDay(QDate::fromJulianDay(next_day_)).first_start != 0)
+			fetched.push_back(next_day_);
+		--next_day_;
+	}
+	if (fetched.empty())
+		return;
+
+	const int first_row = static_cast<int>(days_.size());
+	beginInsertRows(QModelIndex(), first_row, first_row + static_cast<int>(fetched.size()) - 1);
+	days_.insert(days_.end(), fetched.begin(), fetched.end());
+	endInsertRows();
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || (index.row() >= static_cast<int>(days_.size())))
+		return QVariant();
+
+	if (role == Qt::TextAlignmentRole)
+		return static_cast<int>((index.column() == Date) ? (Qt::AlignLeft | Qt::AlignVCenter) : (Qt::AlignRight | Qt::AlignVCenter));
+	if (role != Qt::DisplayRole)
+		return QVariant();
+
+	const qint64 day = days_[static_cast<size_t>(index.row())];
+	const DayRecord record = history_store_.getDay(QDate::fromJulianDay(day));
+	switch (index.column()) {
+		case Date: return QDate::fromJulianDay(day).toString("ddd yyyy-MM-dd");
+		case Activity: return convMSecToHoursStr(record.activity) + "h";
+		case Pause: return convMSecToHoursStr(record.pause) + "h";
+		case FirstStart: return QDateTime::fromMSecsSinceEpoch(record.first_start).toString("hh:mm");
+		case LastStop: return QDateTime::fromMSecsSinceEpoch(record.last_stop).toString("hh:mm");
+		case Sessions: return record.sessions;
+		case Autopauses: return record.autopauses;
+	}
+	return QVariant();
+}
+
+QVariant HistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+		return QAbstractTableModel::headerData(section, orientation, role);
+
+	switch (section) {
+		case Date: return "Date";
+		case Activity: return "Activity";
+		case Pause: return "Pause";
+		case FirstStart: return "First Start";
+		case LastStop: return "Last Stop";
+		case Sessions: return "Sessions";
+		case Autopauses: return "Auto-Pauses";
+	}
+	return QVariant();
+}
+
+qint64 HistoryModel::getSortKey(const qint64 day, const int column) const
+{
+	if (column == Date)
+		return day;
+
+	const DayRecord record = history_store_.getDay(QDate::fromJulianDay(day));
+	switch (column) {
+		case Activity: return record.activity;
+		case Pause: return record.pause;
+		case FirstStart: return QDateTime::fromMSecsSinceEpoch(record.first_start).time().msecsSinceStartOfDay();
+		case LastStop: return QDateTime::fromMSecsSinceEpoch(record.last_stop).time().msecsSinceStartOfDay();
+		case Sessions: return record.sessions;
+		case Autopauses: return record.autopauses;
+	}
+	return day;
+}
+
+void HistoryModel::sort(int column, Qt::SortOrder order)
+{
+	// Newest first is the fetch order, so it keeps fetching incrementally. Any other order needs
+	// every day, but only their numbers and one key each are held.
+	if ((column != Date) || (order != Qt::DescendingOrder))
+		while (canFetchMore(QModelIndex()))
+			fetchMore(QModelIndex());
+
+	std::vector<std::pair<qint64, qint64>> keyed_days;
+	keyed_days.reserve(days_.size());
+	for (const qint64 day : days_)
+		keyed_days.emplace_back(getSortKey(day, column), day);
+	if (order == Qt::AscendingOrder)
+		std::stable_sort(keyed_days.begin(), keyed_days.end());
+	else
+		std::stable_sort(keyed_days.begin(), keyed_days.end(), [](const std::pair<qint64, qint64> &a, const std::pair<qint64, qint64> &b) { return a > b; });
+
+	emit layoutAboutToBeChanged();
+	const std::vector<qint64> old_days = days_;
+	std::map<qint64, int> new_rows;
+	for (size_t i = 0; i < days_.size(); ++i) {
+		days_[i] = keyed_days[i].second;
+		new_rows[days_[i]] = static_cast<int>(i);
+	}
+	const QModelIndexList old_indexes = persistentIndexList();
+	QModelIndexList new_indexes;
+	for (const QModelIndex &old_index : old_indexes)
+		new_indexes.append(index(new_rows[old_days[static_cast<size_t>(old_index.row())]], old_index.column()));
+	changePersistentIndexList(old_indexes, new_indexes);
+	emit layoutChanged();
+}
+
+QDate HistoryModel::getDate(const int row) const
+{
+	return (((row >= 0) && (row < static_cast<int>(days_.size()))) ? QDate::fromJulianDay(days_[static_cast<size_t>(row)]) : QDate());
+}
+
+DayRecord HistoryModel::getRecord(const int row) const
+{
+	return history_store_.getDay(getDate(row));
+}
@@ -0,0 +1,42 @@
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDate>
+#include <QVariant>
+#include <vector>
+#include "historystore.h"
+
+// Days of the history store as table rows, newest first. Rows are fetched in batches while scrolling;
+// a row is only a day number, records are read from the store and formatted when the view asks for them.
+class HistoryModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+private:
+	const HistoryStore & history_store_;
+	std::vector<qint64> days_;
+	qint64 next_day_;		// next day to scan, going back in time
+	qint64 first_day_;	// oldest day with data
+
+	qint64 getSortKey(const qint64 day, const int column) const;
+
+public:
+	enum Column {Date, Activity, Pause, FirstStart, LastStop, Sessions, Autopauses, ColumnCount};
+
+	explicit HistoryModel(const HistoryStore & history_store, QObject *parent = nullptr);
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+	bool canFetchMore(const QModelIndex &parent) const override;
+	void fetchMore(const QModelIndex &parent) override;
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+	QDate getDate(const int row) const;
+	DayRecord getRecord(const int row) const;
+
+public slots:
+	void reload();
+};
+
+#endif // HISTORYMODEL_H
@@ -0,0 +1,192 @@
+#include "historystore.h"
+#include <QDateTime>
+#include <cstring>
+#include <set>
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	struct HistoryHeader
+	{
+		quint32 magic;
+		quint32 version;
+		quint32 record_size;
+		quint32 reserved;
+	};
+
+	const quint32 history_magic = 0x53485455; // "UTHS"
+	const quint32 history_version = 1;
+	const qint64 header_size = sizeof(HistoryHeader);
+	const qint64 record_size = sizeof(DayRecord);
+	const qint64 first_day = 2451545; // Julian Day of 2000-01-01, the day of record 0
+	const qint64 days_per_growth = 366;
+
+	static_assert(sizeof(DayRecord) == 48, "DayRecord is part of the file format");
+}
+
+HistoryStore::HistoryStore(const Settings &settings, const QString &filename, const bool read_only, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		file_(filename),
+		read_only_(read_only),
+		map_(nullptr),
+		day_count_(0)
+{
+	if (!openFile() || !mapFile()) {
+		if (settings_.logToFile())
+			Logger::Log("[HISTORY] Could not open " + filename + ", History is not stored");
+		file_.close();
+		map_ = nullptr;
+	}
+}
+
+HistoryStore::~HistoryStore()
+{
+	if (map_ != nullptr)
+		file_.unmap(map_);
+	file_.close();
+}
+
+bool HistoryStore::openFile()
+{
+	if (!file_.open(read_only_ ? QIODevice::ReadOnly : QIODevice::ReadWrite))
+		return false;
+
+	HistoryHeader header;
+	if ((file_.size() == 0) && !read_only_) {
+		header = HistoryHeader{history_magic, history_version, static_cast<quint32>(record_size), 0};
+		if (file_.write(reinterpret_cast<const char*>(&header), header_size) != header_size)
+			return false;
+	}
+	else if ((file_.read(reinterpret_cast<char*>(&header), header_size) != header_size)
+					 || (header.magic != history_magic) || (header.version != history_version) || (header.record_size != record_size)) {
+		return false;
+	}
+
+	day_count_ = (file_.size() - header_size) / record_size;
+	return true;
+}
+
+bool HistoryStore::mapFile()
+{
+	if (map_ != nullptr)
+		file_.unmap(map_);
+	map_ = file_.map(0, file_.size());
+	return (map_ != nullptr);
+}
+
+bool HistoryStore::isOpen() const
+{
+	return (map_ != nullptr);
+}
+
+QDate HistoryStore::getToday() const
+{
+	return getWorkToday(settings_.getDayStartHour());
+}
+
+qint64 HistoryStore::getDayNumber(const qint64 &msecs, const int day_start_hour)
+{
+	return getWorkDate(msecs, day_start_hour).toJulianDay();
+}
+
+bool HistoryStore::ensureDay(const qint64 day)
+{
+	const qint64 index = day - first_day;
+	if ((map_ == nullptr) || read_only_ || (index < 0))
+		return false;
+	if (index < day_count_)
+		return true;
+
+	// Grown by a year at a time so that the map rarely has to be replaced; the new records read as zero
+	const qint64 new_day_count = index + days_per_growth;
+	file_.unmap(map_);
+	map_ = nullptr;
+	if (!file_.resize(header_size + new_day_count * record_size) || !mapFile()) {
+		if (settings_.logToFile())
+			Logger::Log("[HISTORY] Could not grow History File");
+		mapFile();
+		return false;
+	}
+	day_count_ = new_day_count;
+	return true;
+}
+
+DayRecord * HistoryStore::getRecord(const qint64 day)
+{
+	return reinterpret_cast<DayRecord*>(map_ + header_size + (day - first_day) * record_size);
+}
+
+const DayRecord * HistoryStore::getRecord(const qint64 day) const
+{
+	return reinterpret_cast<const DayRecord*>(map_ + header_size + (day - first_day) * record_size);
+}
+
+DayRecord HistoryStore::getDay(const QDate &date) const
+{
+	DayRecord record;
+	std::memset(&record, 0, sizeof(DayRecord));
+
+	const qint64 day = date.toJulianDay();
+	if ((map_ != nullptr) && (day >= first_day) && (day - first_day < day_count_))
+		std::memcpy(&record, getRecord(day), sizeof(DayRecord));
+	return record;
+}
+
+DayRecord HistoryStore::getRange(const QDate &first, const QDate &last) const
+{
+	DayRecord sum;
+	std::memset(&sum, 0, sizeof(DayRecord));
+
+	for (QDate date = first; date <= last; date = date.addDays(1)) {
+		const DayRecord day = getDay(date);
+		if (day.first_start == 0)
+			continue;
+		sum.activity += day.activity;
+		sum.pause += day.pause;
+		sum.autopauses += day.autopauses;
+		sum.sessions += day.sessions;
+		sum.first_start = (sum.first_start == 0) ? day.first_start : qMin(sum.first_start, day.first_start);
+		sum.last_stop = qMax(sum.last_stop, day.last_stop);
+	}
+	return sum;
+}
+
+QDate HistoryStore::getFirstDate() const
+{
+	for (qint64 index = 0; (map_ != nullptr) && (index < day_count_); ++index)
+		if (getRecord(first_day + index)->first_start != 0)
+			return QDate::fromJulianDay(first_day + index);
+	return QDate();
+}
+
+void HistoryStore::addSession(const std::vector<TimeSegment> &segments)
+{
+	if (read_only_)
+		return;
+
+	// Each segment counts for the day it started on
+	std::set<qint64> days;
+	for (const TimeSegment &segment : segments) {
+		const qint64 day = getDayNumber(segment.start, settings_.getDayStartHour());
+		if (!ensureDay(day))
+			continue;
+
+		DayRecord *record = getRecord(day);
+		if (segment.type == SegmentType::Activity)
+			record->activity += segment.duration;
+		else
+			record->pause += segment.duration;
+		if (segment.type == SegmentType::Autopause)
+			++record->autopauses;
+		record->first_start = (record->first_start == 0) ? segment.start : qMin(record->first_start, segment.start);
+		record->last_stop = qMax(record->last_stop, segment.start + segment.duration);
+		days.insert(day);
+	}
+
+	for (const qint64 day : days)
+		++getRecord(day)->sessions;
+
+	if (!days.empty())
+		emit historyChanged();
+}
@@ -0,0 +1,62 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QFile>
+#include <QDate>
+#include <QString>
+#include <vector>
+#include "settings.h"
+#include "types.h"
+
+// One fixed-size record per calendar day, stored in native byte order
+struct DayRecord
+{
+	qint64 activity;		// msec
+	qint64 pause;			// msec, including autopauses and sleep
+	qint64 first_start;	// msec since epoch, 0 if nothing was tracked that day
+	qint64 last_stop;		// msec since epoch
+	quint32 autopauses;
+	quint32 sessions;
+	quint32 reserved[2];
+};
+
+// Day records in a memory-mapped file, where the position of a record is given by its day number alone.
+// Opening it doesn't read anything, and any day or range of days can be looked up without parsing.
+// Opened read-only, the file is neither created nor grown, and sessions are not added.
+class HistoryStore : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QFile file_;
+	const bool read_only_;
+	uchar *map_;
+	qint64 day_count_;
+
+	bool openFile();
+	bool mapFile();
+	bool ensureDay(const qint64 day);
+	DayRecord * getRecord(const qint64 day);
+	const DayRecord * getRecord(const qint64 day) const;
+
+public:
+	explicit HistoryStore(const Settings & settings, const QString &filename, const bool read_only = false, QObject *parent = nullptr);
+	~HistoryStore();
+	bool isOpen() const;
+	DayRecord getDay(const QDate &date) const;
+	DayRecord getRange(const QDate &first, const QDate &last) const;
+	QDate getFirstDate() const;
+	QDate getToday() const;
+	static qint64 getDayNumber(const qint64 &msecs, const int day_start_hour);
+
+signals:
+	void historyChanged();
+
+public slots:
+	void addSession(const std::vector<TimeSegment> &segments);
+};
+
+#endif // HISTORYSTORE_H
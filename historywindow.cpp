@@ -0,0 +1,106 @@
+#include "historywindow.h"
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QDateTime>
+#include <QStringList>
+#include <set>
+#include "helpers.h"
+
+HistoryWindow::HistoryWindow(const Settings &settings, const HistoryStore &history_store, const SegmentArchive &segment_archive, NoteStore &note_store, const Theme &theme, QWidget *parent)
+	: QWidget(parent, Qt::Window),
+		settings_(settings),
+		segment_archive_(segment_archive),
+		note_store_(note_store),
+		history_model_(history_store)
+{
+	setWindowTitle("µTimer History");
+	setupGUI(theme);
+
+	QObject::connect(table_view_->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &HistoryWindow::showDay);
+	QObject::connect(table_view_->selectionModel(), &QItemSelectionModel::selectionChanged, this, &HistoryWindow::updateTotals);
+	QObject::connect(&note_store_, &NoteStore::notesChanged, this, &HistoryWindow::updateNotes);
+}
+
+void HistoryWindow::setupGUI(const Theme &theme)
+{
+	QVBoxLayout *rows = new QVBoxLayout(this);
+
+	table_view_ = new QTableView();
+	table_view_->setModel(&history_model_);
+	table_view_->setSelectionBehavior(QAbstractItemView::SelectRows);
+	table_view_->setAlternatingRowColors(true);
+	table_view_->verticalHeader()->hide();
+	// Uniform rows, so the view never has to measure rows it doesn't show
+	table_view_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	table_view_->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+	table_view_->horizontalHeader()->setSortIndicator(HistoryModel::Date, Qt::DescendingOrder);
+	table_view_->setSortingEnabled(true);
+
+	timeline_ = new TimelineWidget(theme);
+	notes_text_ = new QLabel();
+	notes_text_->setWordWrap(true);
+	notes_text_->hide();
+	total_text_ = new QLabel();
+
+	rows->addWidget(table_view_);
+	rows->addWidget(timeline_);
+	rows->addWidget(notes_text_);
+	rows->addWidget(total_text_);
+	resize(560, 420);
+}
+
+void HistoryWindow::reload()
+{
+	history_model_.reload();
+	const QHeaderView *header = table_view_->horizontalHeader();
+	history_model_.sort(header->sortIndicatorSection(), header->sortIndicatorOrder());
+	timeline_->setDay(QDate(), settings_.getDayStartHour(), std::vector<TimeSegment>());
+	updateNotes();
+	updateTotals();
+}
+
+void HistoryWindow::showDay(const QModelIndex &current, const QModelIndex &previous)
+{
+	Q_UNUSED(previous);
+	const QDate date = history_model_.getDate(current.row());
+	if (!date.isValid())
+		return;
+	timeline_->setDay(date, settings_.getDayStartHour(), segment_archive_.getSegments(getDayStart(date), getDayStart(date.addDays(1))));
+	updateNotes();
+}
+
+qint64 HistoryWindow::getDayStart(const QDate &date) const
+{
+	// Days in the history are work days, which start at day_starts_at_hour
+	return getWorkDayStartMSec(date, settings_.getDayStartHour());
+}
+
+void HistoryWindow::updateNotes()
+{
+	// Same range as the timeline; the notes are only loaded once a day is shown
+	const QDate date = timeline_->getDate();
+	QStringList notes;
+	if (date.isValid()) {
+		for (const NoteStore::Note &note : note_store_.getNotes(getDayStart(date), getDayStart(date.addDays(1))))
+			notes << QDateTime::fromMSecsSinceEpoch(note.time).toString("hh:mm") + "  " + note.text;
+	}
+	notes_text_->setText(notes.join("\n"));
+	notes_text_->setVisible(!notes.isEmpty());
+}
+
+void HistoryWindow::updateTotals()
+{
+	std::set<int> rows;
+	for (const QModelIndex &index : table_view_->selectionModel()->selectedIndexes())
+		rows.insert(index.row());
+
+	qint64 activity = 0;
+	qint64 pause = 0;
+	for (const int row : rows) {
+		const DayRecord record = history_model_.getRecord(row);
+		activity += record.activity;
+		pause += record.pause;
+	}
+	total_text_->setText(QString::number(rows.size()) + " Days selected: Activity " + convMSecToHoursStr(activity) + "h, Pause " + convMSecToHoursStr(pause) + "h");
+}
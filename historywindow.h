@@ -0,0 +1,46 @@
+#ifndef HISTORYWINDOW_H
+#define HISTORYWINDOW_H
+
+#include <QWidget>
+#include <QTableView>
+#include <QLabel>
+#include <QModelIndex>
+#include <QItemSelection>
+#include "settings.h"
+#include "theme.h"
+#include "historystore.h"
+#include "historymodel.h"
+#include "segmentarchive.h"
+#include "notestore.h"
+#include "timelinewidget.h"
+
+// Browses the stored days; the selected day is shown as timeline with its notes, the totals cover all selected days.
+// Only built on demand and not connected to the timer tick, so a closed window costs nothing.
+class HistoryWindow : public QWidget
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	const SegmentArchive & segment_archive_;
+	NoteStore & note_store_;
+	HistoryModel history_model_;
+	QTableView *table_view_;
+	TimelineWidget *timeline_;
+	QLabel *notes_text_;
+	QLabel *total_text_;
+
+	void setupGUI(const Theme & theme);
+	qint64 getDayStart(const QDate &date) const;
+
+public:
+	explicit HistoryWindow(const Settings & settings, const HistoryStore & history_store, const SegmentArchive & segment_archive, NoteStore & note_store, const Theme & theme, QWidget *parent = nullptr);
+
+public slots:
+	void reload();
+	void showDay(const QModelIndex &current, const QModelIndex &previous);
+	void updateNotes();
+	void updateTotals();
+};
+
+#endif // HISTORYWINDOW_H
@@ -0,0 +1,196 @@
+#include "hookrunner.h"
+#include <QDateTime>
+#include <QTimer>
+#include <algorithm>
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	const size_t max_running = 2;
+	const size_t max_queued = 16;
+	const int token_burst = 3;
+	const qint64 token_refill_msec = 20 * 1000;
+	const int shutdown_grace_msec = 2000;
+}
+
+HookRunner::HookRunner(const Settings &settings, QObject *parent)
+	: QObject(parent),
+		settings_(settings)
+{
+	for (int i = 0; i < transition_count; ++i) {
+		Hook &hook = hooks_[i];
+		hook.arguments = splitCommand(settings_.getHookCommand(static_cast<Transition>(i)));
+		hook.tokens = token_burst;
+		hook.t_refilled = 0;
+	}
+	clock_.start();
+}
+
+HookRunner::~HookRunner()
+{
+	// The stop hook of a quitting app gets a moment to finish; whatever is left is killed
+	QElapsedTimer grace;
+	grace.start();
+	for (QProcess *process : running_) {
+		process->disconnect(this);
+		if (!process->waitForFinished(static_cast<int>(qMax(Q_INT64_C(0), shutdown_grace_msec - grace.elapsed()))))
+			process->kill();
+	}
+	if (!queue_.empty() && settings_.logToFile())
+		Logger::Log("[HOOK] Dropped " + QString::number(queue_.size()) + " queued Hooks on exit");
+}
+
+QStringList HookRunner::splitCommand(const QString &command)
+{
+	// No shell is involved: double quotes group an argument, nothing else is special
+	QStringList arguments;
+	QString argument;
+	bool in_quotes = false;
+	bool has_argument = false;
+	for (const QChar c : command) {
+		if (c == '"') {
+			in_quotes = !in_quotes;
+			has_argument = true;
+		}
+		else if (c.isSpace() && !in_quotes) {
+			if (has_argument)
+				arguments.append(argument);
+			argument.clear();
+			has_argument = false;
+		}
+		else {
+			argument.append(c);
+			has_argument = true;
+		}
+	}
+	if (has_argument)
+		arguments.append(argument);
+	return arguments;
+}
+
+bool HookRunner::takeToken(Hook &hook)
+{
+	const qint64 t_now = clock_.elapsed();
+	const qint64 refills = (t_now - hook.t_refilled) / token_refill_msec;
+	hook.tokens = static_cast<int>(qMin(static_cast<qint64>(token_burst), hook.tokens + refills));
+	hook.t_refilled = (hook.tokens == token_burst) ? t_now : (hook.t_refilled + refills * token_refill_msec);
+	if (hook.tokens == 0)
+		return false;
+	--hook.tokens;
+	return true;
+}
+
+void HookRunner::runHook(Transition transition, qint64 t_active, qint64 t_pause, const QString &project)
+{
+	Hook &hook = hooks_[static_cast<int>(transition)];
+	if (hook.arguments.isEmpty())
+		return;
+
+	const QString name = getTransitionName(transition);
+	if (!takeToken(hook)) {
+		if (settings_.logToFile())
+			Logger::Log("[HOOK] Skipped " + name + " Hook, it ran too often");
+		return;
+	}
+	if (queue_.size() >= max_queued) {
+		if (settings_.logToFile())
+			Logger::Log("[HOOK] Skipped " + name + " Hook, too many Hooks are waiting");
+		return;
+	}
+
+	// Placeholders are replaced inside single arguments, so their values can't add arguments
+	const QString time = QDateTime::currentDateTime().toString(Qt::ISODate);
+	Job job{name, QStringList()};
+	for (QString argument : hook.arguments) {
+		argument.replace("{event}", name);
+		argument.replace("{time}", time);
+		argument.replace("{active}", convMSecToTimeStr(t_active));
+		argument.replace("{pause}", convMSecToTimeStr(t_pause));
+		argument.replace("{active_msec}", QString::number(t_active));
+		argument.replace("{pause_msec}", QString::number(t_pause));
+		argument.replace("{project}", project);
+		job.arguments.append(argument);
+	}
+	queue_.push_back(job);
+	startQueued();
+}
+
+void HookRunner::runWarningHook(qint64 t_active, qint64 t_pause, const QString &project)
+{
+	runHook(Transition::Warning, t_active, t_pause, project);
+}
+
+void HookRunner::startQueued()
+{
+	while ((running_.size() < max_running) && !queue_.empty()) {
+		const Job job = queue_.front();
+		queue_.pop_front();
+
+		QProcess *process = new QProcess(this);
+		process->setProperty("hook", job.name);
+		process->setStandardOutputFile(QProcess::nullDevice());
+		process->setStandardErrorFile(QProcess::nullDevice());
+		QObject::connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &HookRunner::finishProcess);
+		QObject::connect(process, &QProcess::errorOccurred, this, &HookRunner::reactOnProcessError);
+
+		QTimer *timeout = new QTimer(process);
+		timeout->setSingleShot(true);
+		QObject::connect(timeout, &QTimer::timeout, this, &HookRunner::killTimedOut);
+		timeout->start(settings_.getHookTimeoutMsec());
+
+		running_.push_back(process);
+		if (settings_.logToFile())
+			Logger::Log("[HOOK] Running " + job.name + " Hook: " + job.arguments.join(' '));
+		process->start(job.arguments.first(), job.arguments.mid(1));
+	}
+}
+
+void HookRunner::removeProcess(QProcess *process)
+{
+	const auto it = std::find(running_.begin(), running_.end(), process);
+	if (it == running_.end())
+		return;
+	running_.erase(it);
+	process->deleteLater();
+}
+
+void HookRunner::finishProcess(int exit_code, QProcess::ExitStatus exit_status)
+{
+	QProcess *process = qobject_cast<QProcess *>(sender());
+	if (process == nullptr)
+		return;
+
+	if (settings_.logToFile()) {
+		const QString name = process->property("hook").toString();
+		if (exit_status == QProcess::CrashExit)
+			Logger::Log("[HOOK] " + name + " Hook crashed or was killed");
+		else if (exit_code != 0)
+			Logger::Log("[HOOK] " + name + " Hook exited with " + QString::number(exit_code));
+	}
+	removeProcess(process);
+	startQueued();
+}
+
+void HookRunner::reactOnProcessError(QProcess::ProcessError error)
+{
+	// Only a failed start isn't followed by finished()
+	QProcess *process = qobject_cast<QProcess *>(sender());
+	if ((process == nullptr) || (error != QProcess::FailedToStart))
+		return;
+
+	if (settings_.logToFile())
+		Logger::Log("[HOOK] " + process->property("hook").toString() + " Hook failed to start: " + process->errorString());
+	removeProcess(process);
+	startQueued();
+}
+
+void HookRunner::killTimedOut()
+{
+	QProcess *process = qobject_cast<QProcess *>(sender()->parent());
+	if (process == nullptr)
+		return;
+
+	if (settings_.logToFile())
+		Logger::Log("[HOOK] " + process->property("hook").toString() + " Hook timed out, killing it");
+	process->kill();
+}
@@ -0,0 +1,62 @@
+#ifndef HOOKRUNNER_H
+#define HOOKRUNNER_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <deque>
+#include <vector>
+#include "settings.h"
+#include "types.h"
+
+// Runs the commands configured for timer transitions. Commands are started asynchronously by a
+// small pool of QProcess workers and killed after a timeout, so a slow or hanging command never
+// blocks the timer or the UI. Each transition may only run a few times in a row before it is rate limited.
+class HookRunner : public QObject
+{
+	Q_OBJECT
+
+private:
+	struct Hook
+	{
+		QStringList arguments;	// program first, with {placeholders}
+		int tokens;
+		qint64 t_refilled;
+	};
+
+	struct Job
+	{
+		QString name;
+		QStringList arguments;
+	};
+
+	const Settings & settings_;
+	std::array<Hook, transition_count> hooks_;	// by Transition
+	std::deque<Job> queue_;
+	std::vector<QProcess *> running_;
+	QElapsedTimer clock_;
+
+	bool takeToken(Hook &hook);
+	void removeProcess(QProcess *process);
+	static QStringList splitCommand(const QString &command);
+
+private slots:
+	void startQueued();
+	void finishProcess(int exit_code, QProcess::ExitStatus exit_status);
+	void reactOnProcessError(QProcess::ProcessError error);
+	void killTimedOut();
+
+public:
+	explicit HookRunner(const Settings & settings, QObject *parent = nullptr);
+	~HookRunner();
+
+public slots:
+	void runHook(Transition transition, qint64 t_active, qint64 t_pause, const QString &project);
+	void runWarningHook(qint64 t_active, qint64 t_pause, const QString &project);
+};
+
+#endif // HOOKRUNNER_H
@@ -0,0 +1,73 @@
+#include "inputidlewatcher.h"
+#include <Windows.h>
+#include "logger.h"
+
+namespace {
+	const qint64 recheck_while_idle_msec = 1000;
+}
+
+InputIdleWatcher::InputIdleWatcher(const Settings &settings, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		idle_(false),
+		last_idle_time_(0)
+{
+	alarm_.setSingleShot(true);
+	QObject::connect(&alarm_, &QTimer::timeout, this, &InputIdleWatcher::checkIdleTime);
+
+	// The first check waits for the event loop, its signals are only connected after construction
+	if (settings_.isInputIdleAutopauseEnabled() && (settings_.getBackpauseMsec() > 0))
+		alarm_.start(0);
+}
+
+qint64 InputIdleWatcher::getIdleTime() const
+{
+	LASTINPUTINFO last_input;
+	last_input.cbSize = sizeof(LASTINPUTINFO);
+	if (!GetLastInputInfo(&last_input))
+		return 0;
+
+	// Both are 32 bit tick counts, unsigned subtraction stays correct across their wrap-around after 49.7 days
+	return static_cast<qint64>(static_cast<DWORD>(GetTickCount() - last_input.dwTime));
+}
+
+void InputIdleWatcher::setAlarm(const qint64 t_msec)
+{
+	alarm_.start(static_cast<int>(qBound(Q_INT64_C(1), t_msec, Q_INT64_C(24) * 3600 * 1000)));
+}
+
+void InputIdleWatcher::checkIdleTime()
+{
+	// Instead of sampling every tick, the alarm is set to the earliest moment the threshold can be
+	// reached. Any input in between only pushes that moment back, which the next check finds out.
+	// Only while idle is the input checked every second, to notice its return.
+	const qint64 t_idle = getIdleTime();
+	const qint64 t_threshold = settings_.getBackpauseMsec();
+
+	if (!idle_) {
+		if (t_idle >= t_threshold) {
+			idle_ = true;
+			if (settings_.logToFile())
+				Logger::Log("[IDLE] >> No Input since " + QString::number(t_idle) + "ms");
+			emit inputIdle(t_idle);
+			setAlarm(recheck_while_idle_msec);
+		}
+		else {
+			setAlarm(t_threshold - t_idle);
+		}
+	}
+	else {
+		if (t_idle < last_idle_time_) {
+			idle_ = false;
+			if (settings_.logToFile())
+				Logger::Log("[IDLE] Input resumed <<, " + QString::number(t_idle) + "ms ago");
+			emit inputResumed(t_idle);
+			setAlarm(t_threshold - t_idle);
+		}
+		else {
+			setAlarm(recheck_while_idle_msec);
+		}
+	}
+
+	last_idle_time_ = t_idle;
+}
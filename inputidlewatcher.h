@@ -0,0 +1,34 @@
+#ifndef INPUTIDLEWATCHER_H
+#define INPUTIDLEWATCHER_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QTimer>
+#include "settings.h"
+
+
+class InputIdleWatcher : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QTimer alarm_;
+	bool idle_;
+	qint64 last_idle_time_;
+
+	qint64 getIdleTime() const;
+	void setAlarm(const qint64 t_msec);
+
+private slots:
+	void checkIdleTime();
+
+public:
+	explicit InputIdleWatcher(const Settings & settings, QObject *parent = nullptr);
+
+signals:
+	void inputIdle(qint64 t_idle);
+	void inputResumed(qint64 t_since_input);
+};
+
+#endif // INPUTIDLEWATCHER_H
@@ -4,15 +4,20 @@
 #include <algorithm>
 #include <WtsApi32.h>
 #include "logger.h"
+#include "metrics.h"
 
-LockStateWatcher::LockStateWatcher(const Settings &settings, QWidget *parent)
-	: QWidget(parent),
+LockStateWatcher::LockStateWatcher(const Settings &settings, QObject *parent)
+	: QObject(parent),
 		settings_(settings),
+		lock_offset_(0),
+		away_reported_(false),
 		lock_state_buffer_{ false, false, false, false, false},
+		sample_time_buffer_{ 0, 0, 0, 0, 0},
 		buffer_for_lock{ false, false, true, true, true},
 		buffer_for_unlock{ true, true, false, false, false}
 {
 	lock_timer_.invalidate();
+	sample_clock_.start();
 }
 
 bool LockStateWatcher::isSessionLocked()
@@ -24,6 +29,7 @@ bool LockStateWatcher::isSessionLocked()
 	WTSINFOEXW * pInfo = nullptr;
 	WTS_INFO_CLASS wtsic = WTSSessionInfoEx;
 	bool bRet = false;
+	bool bQueried = false;
 	LPTSTR ppBuffer = nullptr;
 	DWORD dwBytesReturned = 0;
 	LONG dwFlags = 0;
@@ -32,6 +38,7 @@ bool LockStateWatcher::isSessionLocked()
 
 	HMODULE hLib = LoadLibraryW(L"wtsapi32.dll");
 	if (!hLib) {
+		Metrics::count(Metrics::Counter::LockQueryFailures);
 		return false;
 	}
 
@@ -52,12 +59,15 @@ bool LockStateWatcher::isSessionLocked()
 				}
 				pWTSFreeMemory(ppBuffer);
 				ppBuffer = nullptr;
+				bQueried = true;
 			}
 		}
 	}
 	if (hLib != nullptr) {
 		FreeLibrary(hLib);
 	}
+	if (!bQueried)
+		Metrics::count(Metrics::Counter::LockQueryFailures);
 	return bRet;
 }
 
@@ -65,6 +75,8 @@ LockEvent LockStateWatcher::determineLockEvent(bool session_locked)
 {
 	lock_state_buffer_.push_back(session_locked);
 	lock_state_buffer_.pop_front();
+	sample_time_buffer_.push_back(sample_clock_.elapsed());
+	sample_time_buffer_.pop_front();
 
 	if (lock_state_buffer_ == buffer_for_lock)
 		return LockEvent::Lock;
@@ -74,32 +86,83 @@ LockEvent LockStateWatcher::determineLockEvent(bool session_locked)
 		return LockEvent::None;
 }
 
+qint64 LockStateWatcher::getTimeSinceTransition() const
+{
+	// The transition happened between the last sample of the old state and the first sample of the new one.
+	// Normally that gap is one tick, but after an event loop stall it can be minutes, so take its middle
+	const qint64 t_transition = (sample_time_buffer_[1] + sample_time_buffer_[2]) / 2;
+	return (sample_time_buffer_.back() - t_transition);
+}
+
+qint64 LockStateWatcher::getLockDuration() const
+{
+	return (lock_timer_.elapsed() + lock_offset_);
+}
+
 void LockStateWatcher::update()
 {
 	const LockEvent lock_event = determineLockEvent(isSessionLocked());
 
 	if (lock_event == LockEvent::Lock) {
-		if (settings_.logToFile())
-			Logger::Log("[LOCK] >> Lock determined");
+		lock_offset_ = getTimeSinceTransition();
 		lock_timer_.start();
+		if (settings_.logToFile())
+			Logger::Log("[LOCK] >> Lock determined, started " + QString::number(lock_offset_) + "ms ago");
 	}
 	else if (lock_event == LockEvent::Unlock) {
+		const qint64 t_since_unlock = getTimeSinceTransition();
 		if (settings_.logToFile() && lock_timer_.isValid())
-			Logger::Log("[LOCK] Current Lock Duration = " + QString::number(lock_timer_.elapsed()) + "ms");
+			Logger::Log("[LOCK] Current Lock Duration = " + QString::number(getLockDuration() - t_since_unlock) + "ms");
 		lock_timer_.invalidate();
+		away_reported_ = false;
 		if (settings_.logToFile())
-			Logger::Log("[LOCK] Unlock determined <<");
+			Logger::Log("[LOCK] Unlock determined <<, happened " + QString::number(t_since_unlock) + "ms ago");
 		if (settings_.isAutopauseEnabled())
-			emit desktopLockEvent(LockEvent::Unlock);
+			emit desktopLockEvent(LockEvent::Unlock, t_since_unlock);
 	}
 
-	if (lock_timer_.isValid() && (lock_timer_.elapsed() >= settings_.getBackpauseMsec())) {
-		if (settings_.logToFile() && lock_timer_.isValid())
-			Logger::Log("[LOCK] Current Lock Duration = " + QString::number(lock_timer_.elapsed()) + "ms");
-		lock_timer_.invalidate();
-		if (settings_.logToFile())
+	// The lock duration is measured, not assumed to be the threshold: if the event loop stalled
+	// across the threshold crossing, the whole overshoot still has to go into the retroactive pause
+	if (lock_timer_.isValid() && (getLockDuration() >= settings_.getBackpauseMsec())) {
+		const qint64 t_lock = getLockDuration();
+		if (settings_.logToFile()) {
+			Logger::Log("[LOCK] Current Lock Duration = " + QString::number(t_lock) + "ms");
 			Logger::Log("[LOCK] Ongoing Lock is long enough to be counted as a Pause");
-		if (settings_.isAutopauseEnabled())
-			emit desktopLockEvent(LockEvent::LongOngoingLock);
+		}
+		reportAway(t_lock);
 	}
 }
+
+void LockStateWatcher::reportAway(const qint64 t_away)
+{
+	// Lock and input idle usually overlap, the one reaching the threshold first starts the
+	// autopause and the other one must not report the same absence again
+	lock_timer_.invalidate();
+	if (away_reported_)
+		return;
+
+	away_reported_ = true;
+	if (settings_.isAutopauseEnabled())
+		emit desktopLockEvent(LockEvent::LongOngoingLock, t_away);
+}
+
+void LockStateWatcher::registerInputIdle(qint64 t_idle)
+{
+	if (settings_.logToFile())
+		Logger::Log("[LOCK] Input Idle is long enough to be counted as a Pause");
+	reportAway(t_idle);
+}
+
+void LockStateWatcher::registerInputResumed(qint64 t_since_input)
+{
+	// While the session is locked, returning input belongs to the lock screen; the unlock ends the absence then
+	const bool session_locked = lock_state_buffer_.back();
+	if (!away_reported_ || session_locked)
+		return;
+
+	away_reported_ = false;
+	if (settings_.logToFile())
+		Logger::Log("[LOCK] Input after Idle counts as Unlock <<");
+	if (settings_.isAutopauseEnabled())
+		emit desktopLockEvent(LockEvent::Unlock, t_since_input);
+}
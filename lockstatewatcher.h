@@ -1,7 +1,7 @@
 #ifndef LOCKSTATEWATCHER_H
 #define LOCKSTATEWATCHER_H
 
-#include <QWidget>
+#include <QObject>
 #include <Windows.h>
 #include <QElapsedTimer>
 #include <deque>
@@ -11,28 +11,37 @@
 #include "types.h"
 
 
-class LockStateWatcher : public QWidget
+class LockStateWatcher : public QObject
 {
 	Q_OBJECT
 
 private:
 	const Settings & settings_;
 	QElapsedTimer lock_timer_;
+	QElapsedTimer sample_clock_;
+	qint64 lock_offset_;
+	bool away_reported_;
 	std::deque<bool> lock_state_buffer_;
+	std::deque<qint64> sample_time_buffer_;
 	const std::deque<bool> buffer_for_lock;
 	const std::deque<bool> buffer_for_unlock;
 
 	bool isSessionLocked();
 	LockEvent determineLockEvent(bool session_locked);
+	qint64 getTimeSinceTransition() const;
+	qint64 getLockDuration() const;
+	void reportAway(const qint64 t_away);
 
 public:
-	explicit LockStateWatcher(const Settings & settings, QWidget *parent = nullptr);
+	explicit LockStateWatcher(const Settings & settings, QObject *parent = nullptr);
 
 signals:
-	void desktopLockEvent(LockEvent event);
+	void desktopLockEvent(LockEvent event, qint64 t_elapsed);
 
 public slots:
 	void update();
+	void registerInputIdle(qint64 t_idle);
+	void registerInputResumed(qint64 t_since_input);
 };
 
 #endif // LOCKSTATEWATCHER_H
@@ -1,11 +1,17 @@
 #include "logger.h"
 #include <QDateTime>
-#include <QTextStream>
+#include "metrics.h"
+
+namespace {
+	const qint64 max_log_bytes = 8 * 1024 * 1024;	// two files at most, the current and the previous one
+	const QString log_name = "utimer.log";
+	const QString previous_log_name = "utimer.log.1";
+}
 
 Logger::Logger()
 {
 	logfile_ = new QFile();
-	logfile_->setFileName("utimer.log");
+	logfile_->setFileName(log_name);
 	logfile_->open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text);
 	log("uTimer Startup");
 }
@@ -18,11 +24,22 @@ void Logger::Log(const QString &text)
 
 void Logger::log(const QString &text)
 {
-	const QString msg = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz: ") + text + "\n";
-	QTextStream out(logfile_);
-	out.setCodec("UTF-8");
-	if (logfile_ != nullptr)
-		out << msg;
+	const QByteArray msg = (QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz: ") + text + "\n").toUtf8();
+	if (logfile_ != nullptr) {
+		if (logfile_->pos() + msg.size() > max_log_bytes)
+			rotate();
+		logfile_->write(msg);
+	}
+	Metrics::count(Metrics::Counter::LogLines);
+	Metrics::count(Metrics::Counter::LogBytes, static_cast<quint64>(msg.size()));
+}
+
+void Logger::rotate()
+{
+	logfile_->close();
+	QFile::remove(previous_log_name);
+	QFile::rename(log_name, previous_log_name);
+	logfile_->open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text);
 }
 
 Logger::~Logger()
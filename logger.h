@@ -10,6 +10,7 @@ class Logger
 
 	Logger();
 	void log(const QString & text);
+	void rotate();
 
 public:
 	static void Log(const QString & text);
@@ -1,43 +1,295 @@
 #include <QApplication>
-#include <QStyleFactory>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QEvent>
 #include <QTimer>
 #include <QSettings>
+#include <QMetaObject>
+#include <QFile>
+#include <QDate>
+#include <QTextStream>
+#include <QLockFile>
+#include <QStringList>
+#include <cstdio>
+#include <Windows.h>
+#include <memory>
 
 #include "settings.h"
 #include "mainwin.h"
-#include "timetracker.h"
-#include "lockstatewatcher.h"
+#include "tracking.h"
+#include "controlserver.h"
+#include "controlclient.h"
+#include "metricsserver.h"
+#include "startupprofiler.h"
+#include "exporter.h"
+#include "helpers.h"
 #include "types.h"
 
-int main(int argc, char *argv[])
+namespace {
+
+bool hasArgument(int argc, char *argv[], const char *argument)
 {
-	QCoreApplication::setApplicationName("µTimer");
+	for (int i = 1; i < argc; ++i)
+		if (qstrcmp(argv[i], argument) == 0)
+			return true;
+	return false;
+}
 
-	QApplication application(argc, argv);
-	application.setStyle(QStyleFactory::create("Fusion"));
+QString getArgument(int argc, char *argv[], const char *argument)
+{
+	for (int i = 1; i + 1 < argc; ++i)
+		if (qstrcmp(argv[i], argument) == 0)
+			return QString::fromLocal8Bit(argv[i + 1]);
+	return QString();
+}
+
+// Output of a Windows subsystem program only shows up in the console it was started from once it is
+// attached to it; stdout and stderr redirected by the caller are kept as they are
+bool attachParentConsole()
+{
+	if (!AttachConsole(ATTACH_PARENT_PROCESS))
+		return false;
+	if (_fileno(stdout) < 0)
+		std::freopen("CONOUT$", "w", stdout);
+	if (_fileno(stderr) < 0)
+		std::freopen("CONOUT$", "w", stderr);
+	return true;
+}
+
+BOOL WINAPI consoleCtrlHandler(DWORD ctrl_type)
+{
+	// Called on a separate thread; quitting the event loop lets TimeTracker stop and log as usual
+	QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+	if ((ctrl_type == CTRL_CLOSE_EVENT) || (ctrl_type == CTRL_LOGOFF_EVENT) || (ctrl_type == CTRL_SHUTDOWN_EVENT))
+		Sleep(2000); // the process is terminated as soon as this returns
+	return TRUE;
+}
+
+int runHeadless(int argc, char *argv[])
+{
+	StartupProfiler startup_profiler;
+
+	// uTimer is built for the Windows subsystem, so it has no console of its own. Attached to the one
+	// it was started from, Ctrl+C and closing that console reach consoleCtrlHandler; without one,
+	// "utimerctl quit" ends it.
+	AttachConsole(ATTACH_PARENT_PROCESS);
 
-	QTimer timer;
+	QCoreApplication application(argc, argv);
+	startup_profiler.mark("Application");
 
 	Settings settings("user-settings.ini");
-	LockStateWatcher lockstate_watcher(settings);
-	TimeTracker time_tracker(settings);
-	MainWin main_win(settings);
+	startup_profiler.mark("Settings");
+	Tracking tracking(settings);
+	startup_profiler.mark("Tracking");
 
-	QObject::connect(&main_win, SIGNAL(sendButtons(Button)),	&time_tracker, SLOT(useTimerViaButton(Button)));
+	std::unique_ptr<ControlServer> control_server;
+	if (settings.isControlSocketEnabled()) {
+		control_server.reset(new ControlServer(settings, tracking.time_tracker, tracking.note_store));
+		QObject::connect(control_server.get(), &ControlServer::sendButtons, &tracking.time_tracker, &TimeTracker::useTimerViaButton);
+		QObject::connect(control_server.get(), &ControlServer::sendEdit, &tracking.time_tracker, &TimeTracker::useTimerViaEdit);
+		QObject::connect(control_server.get(), &ControlServer::sendProject, &tracking.time_tracker, &TimeTracker::useTimerViaProject);
+		QObject::connect(control_server.get(), &ControlServer::quitRequested, &application, &QCoreApplication::quit, Qt::QueuedConnection);
+	}
 
-	QObject::connect(&timer, SIGNAL(timeout()), &time_tracker, SLOT(sendTimes()));
-	QObject::connect(&time_tracker, SIGNAL(sendAllTimes(qint64,qint64)), &main_win, SLOT(updateAllTimes(qint64,qint64)));
+	std::unique_ptr<MetricsServer> metrics_server;
+	if (settings.getMetricsPort() > 0)
+		metrics_server.reset(new MetricsServer(settings));
 
-	QObject::connect(&timer, SIGNAL(timeout()), &lockstate_watcher, SLOT(update()));
-	QObject::connect(&lockstate_watcher, SIGNAL(desktopLockEvent(LockEvent)),	&time_tracker, SLOT(useTimerViaLockEvent(LockEvent)));
-	QObject::connect(&lockstate_watcher, SIGNAL(desktopLockEvent(LockEvent)), &main_win, SLOT(reactOnLockState(LockEvent)));
+	SetConsoleCtrlHandler(consoleCtrlHandler, TRUE);
 
-	timer.setInterval(100);
-	timer.start();
+	tracking.timer.start();
+
+	if (settings.isAutostartTimingEnabled())
+		tracking.time_tracker.useTimerViaButton(Button::Start);
+	startup_profiler.mark("Timer Start");
+	startup_profiler.markMilestone("Time to Tracking");
+
+	QTimer::singleShot(0, [&]() {
+		startup_profiler.mark("First Event Loop Iteration");
+		startup_profiler.log(settings);
+	});
+
+	return application.exec();
+}
+
+// uTimer --export csv|jsonl|ics [--days] [--from yyyy-MM-dd] [--to yyyy-MM-dd] [--out file]
+// Reads the stored history only, so it can run from a scheduler next to a running instance
+int runExport(int argc, char *argv[])
+{
+	QCoreApplication application(argc, argv);
+	QTextStream err(stderr);
+
+	ExportFormat format;
+	if (!Exporter::parseFormat(getArgument(argc, argv, "--export"), format)) {
+		err << "Unknown export format, use csv, jsonl or ics" << endl;
+		return 2;
+	}
+
+	// The export may run beside a tracking instance, so it only reads: no settings write-back,
+	// no log, and neither history file is created, repaired or grown
+	Settings settings("user-settings.ini", true);
+	const int day_start_hour = settings.getDayStartHour();
+
+	// Dates are work days like everywhere else, which start at day_starts_at_hour
+	const QString from_str = getArgument(argc, argv, "--from");
+	const QString to_str = getArgument(argc, argv, "--to");
+	const QDate first = from_str.isEmpty() ? QDate(2000, 1, 1) : QDate::fromString(from_str, Qt::ISODate);
+	const QDate last = to_str.isEmpty() ? getWorkToday(day_start_hour) : QDate::fromString(to_str, Qt::ISODate);
+	if (!first.isValid() || !last.isValid()) {
+		err << "Invalid date, use yyyy-MM-dd" << endl;
+		return 2;
+	}
+
+	const QString out_name = getArgument(argc, argv, "--out");
+	QFile out(out_name);
+	const bool opened = out_name.isEmpty() ? out.open(stdout, QIODevice::WriteOnly) : out.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	if (!opened) {
+		err << "Could not open " << out_name << endl;
+		return 1;
+	}
+
+	Projects projects(settings, "projects.txt");
+	Exporter exporter(out, format, projects);
+	bool ok = false;
+	if (hasArgument(argc, argv, "--days")) {
+		HistoryStore history_store(settings, "history.dat", true);
+		ok = history_store.isOpen() && exporter.exportDays(history_store, first, last);
+	}
+	else {
+		SegmentArchive segment_archive(settings, "segments.dat", true);
+		ok = segment_archive.isOpen() && exporter.exportSegments(segment_archive, getWorkDayStartMSec(first, day_start_hour), getWorkDayStartMSec(last.addDays(1), day_start_hour));
+	}
+
+	if (!ok)
+		err << "Export failed" << endl;
+	return (ok ? 0 : 1);
+}
+
+// Without a console, the hand-off reports in a plain Windows message box, so it needs no widgets
+void showWarning(const QString &message)
+{
+	MessageBoxW(nullptr, reinterpret_cast<const wchar_t*>(message.utf16()), L"uTimer", MB_OK | MB_ICONWARNING);
+}
+
+// Everything on the command line that isn't an option is a control command, "show" if there is none.
+// Started without a console, a failure would go unnoticed, so it is shown in a message box instead.
+int forwardToRunningInstance(int argc, char *argv[])
+{
+	const bool has_console = attachParentConsole();
+	QCoreApplication application(argc, argv);
+
+	QStringList arguments;
+	for (const QString &argument : application.arguments().mid(1))
+		if (!argument.startsWith("--"))
+			arguments << argument;
+	QStringList commands = groupControlCommands(arguments);
+	if (commands.isEmpty())
+		commands << "show";
+
+	QList<QByteArray> responses;
+	if (!sendControlRequests(commands, responses)) {
+		const QString message = "uTimer is already running, but doesn't respond on its Control Socket (see enable_control_socket in user-settings.ini)";
+		if (has_console)
+			std::fprintf(stderr, "%s\n", message.toLocal8Bit().constData());
+		else
+			showWarning(message);
+		return 2;
+	}
+
+	int exit_code = 0;
+	QStringList errors;
+	for (int i = 0; i < responses.size(); ++i) {
+		if (!responses[i].startsWith("OK")) {
+			exit_code = 1;
+			errors << commands[i] + ": " + QString::fromUtf8(responses[i]);
+		}
+		std::printf("%s\n", responses[i].constData());
+	}
+	if (!has_console && !errors.isEmpty())
+		showWarning(errors.join("\n"));
+	return exit_code;
+}
+
+int runGui(int argc, char *argv[])
+{
+	StartupProfiler startup_profiler;
+
+	QApplication application(argc, argv);
+	startup_profiler.mark("Application");
+
+	Settings settings("user-settings.ini");
+	startup_profiler.mark("Settings");
+	Tracking tracking(settings);
+	startup_profiler.mark("Tracking");
+	MainWin main_win(settings, tracking.history_store, tracking.segment_archive, tracking.time_tracker, tracking.shared_history, tracking.projects, tracking.note_store);
+	startup_profiler.mark("Main Window");
+
+	QObject::connect(&main_win, &MainWin::sendButtons,	&tracking.time_tracker, &TimeTracker::useTimerViaButton);
+	QObject::connect(&main_win, &MainWin::sendEdit, &tracking.time_tracker, &TimeTracker::useTimerViaEdit);
+	QObject::connect(&main_win, &MainWin::sendProject, &tracking.time_tracker, &TimeTracker::useTimerViaProject);
+
+	// The 10 Hz path stays on one thread, so it is always called directly
+	QObject::connect(&tracking.timer, &QTimer::timeout, &tracking.time_tracker, &TimeTracker::sendTimes, Qt::DirectConnection);
+	QObject::connect(&tracking.time_tracker, &TimeTracker::sendAllTimes, &main_win, &MainWin::updateAllTimes, Qt::DirectConnection);
+
+	QObject::connect(&tracking.time_tracker, &TimeTracker::modeChanged, &main_win, &MainWin::reactOnModeChange);
+	QObject::connect(&tracking.history_store, &HistoryStore::historyChanged, &main_win, &MainWin::updateHistorySummary);
+	QObject::connect(&tracking.shared_history, &SharedHistory::mergedActivityChanged, &main_win, &MainWin::updateHistorySummary);
+	QObject::connect(&main_win, &MainWin::warningShown, &tracking.hook_runner, &HookRunner::runWarningHook);
+	QObject::connect(&tracking.time_tracker, &TimeTracker::segmentAdded, &main_win, &MainWin::addTimelineSegment);
+	QObject::connect(&tracking.time_tracker, &TimeTracker::segmentsEdited, &main_win, &MainWin::reloadTimeline);
+	QObject::connect(&tracking.time_tracker, &TimeTracker::projectChanged, &main_win, &MainWin::updateProjects);
+	QObject::connect(&tracking.projects, &Projects::projectAdded, &main_win, &MainWin::updateProjects);
+
+	// Remote buttons go through the GUI like clicks, so window and tracker stay in the same state
+	std::unique_ptr<ControlServer> control_server;
+	if (settings.isControlSocketEnabled()) {
+		control_server.reset(new ControlServer(settings, tracking.time_tracker, tracking.note_store));
+		QObject::connect(control_server.get(), &ControlServer::sendButtons, &main_win, &MainWin::pressButton);
+		QObject::connect(control_server.get(), &ControlServer::showRequested, &main_win, &MainWin::raiseMainWin);
+		QObject::connect(control_server.get(), &ControlServer::sendEdit, &tracking.time_tracker, &TimeTracker::useTimerViaEdit);
+		QObject::connect(control_server.get(), &ControlServer::sendProject, &tracking.time_tracker, &TimeTracker::useTimerViaProject);
+		QObject::connect(control_server.get(), &ControlServer::quitRequested, &application, &QCoreApplication::quit, Qt::QueuedConnection);
+	}
+
+	std::unique_ptr<MetricsServer> metrics_server;
+	if (settings.getMetricsPort() > 0)
+		metrics_server.reset(new MetricsServer(settings));
+
+	tracking.timer.start();
 
 	main_win.start();
+	startup_profiler.mark("Timer Start");
+	startup_profiler.markMilestone("Time to Tracking");
+
+	QTimer::singleShot(0, [&]() {
+		startup_profiler.mark("First Event Loop Iteration");
+		startup_profiler.log(settings);
+	});
 
 	return application.exec();
 }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication::setApplicationName("µTimer");
+
+	// Exports only read the stored history, so they may run next to a tracking instance
+	if (hasArgument(argc, argv, "--export"))
+		return runExport(argc, argv);
+
+	// Only one instance may track time, write the log and the settings. A second launch hands its
+	// command line to the first one and exits before any settings, log or widgets are touched.
+	QLockFile instance_lock("uTimer.lock");
+	instance_lock.setStaleLockTime(0);
+	if (!instance_lock.tryLock(0))
+		return forwardToRunningInstance(argc, argv);
+
+	// Decided before any application object exists: the headless mode must never load widgets or styles
+	if (hasArgument(argc, argv, "--headless"))
+		return runHeadless(argc, argv);
+	else
+		return runGui(argc, argv);
+}
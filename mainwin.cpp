@@ -1,31 +1,107 @@
 #include "mainwin.h"
 #include <QtDebug>
 #include <QTime>
+#include <QDateTime>
 #include <QSystemTrayIcon>
 #include <QMessageBox>
+#include <QApplication>
+#include <QStyleFactory>
+#include <QMenu>
+#include <QInputDialog>
 #include "helpers.h"
+#include "segmenteditdialog.h"
 
+namespace {
+	const qint64 merged_summary_step_msec = 36000; // the 0.01 h shown
+}
 
-
-MainWin::MainWin(Settings &settings, QWidget *parent)	: QMainWindow(parent), settings_(settings), warning_activity_shown_(false), warning_pause_shown_(false), was_active_before_autopause_(false)
+MainWin::MainWin(Settings &settings, const HistoryStore &history_store, const SegmentArchive &segment_archive, const TimeTracker &time_tracker, const SharedHistory &shared_history, const Projects &projects, NoteStore &note_store, QWidget *parent)	: QMainWindow(parent), content_widget_(nullptr), settings_(settings), history_store_(history_store), segment_archive_(segment_archive), time_tracker_(time_tracker), shared_history_(shared_history), projects_(projects), note_store_(note_store), report_dialog_(nullptr), history_window_(nullptr), note_search_dialog_(nullptr), mode_(TimeTracker::Mode::None), merged_summary_step_(-1), warning_activity_shown_(false), warning_pause_shown_(false)
 {
-	setupCentralWidget(settings);
-
 	setupIcon();
 
 	setWindowTitle("µTimer");
 	setWindowFlags(windowFlags() &(~Qt::WindowMaximizeButtonHint));
+
+	if (!settings_.isMinimizedStartEnabled())
+		ensureCentralWidget();
 }
 
-void MainWin::setupCentralWidget(Settings &settings)
+void MainWin::setupCentralWidget()
 {
-	content_widget_ = new ContentWidget(settings, this);
+	content_widget_ = new ContentWidget(settings_, *theme_, this);
 
 	setCentralWidget(content_widget_);
 
-	QObject::connect(content_widget_, SIGNAL(pressedButton(Button)), this, SIGNAL(sendButtons(Button)));
-	QObject::connect(content_widget_, SIGNAL(minToTray()), this, SLOT(minToTray()));
-	QObject::connect(content_widget_, SIGNAL(toggleAlwaysOnTop()), this, SLOT(toggleAlwaysOnTop()));
+	QObject::connect(content_widget_, &ContentWidget::pressedButton, this, &MainWin::sendButtons);
+	QObject::connect(content_widget_, &ContentWidget::minToTray, this, &MainWin::minToTray);
+	QObject::connect(content_widget_, &ContentWidget::toggleAlwaysOnTop, this, &MainWin::toggleAlwaysOnTop);
+	QObject::connect(content_widget_, &ContentWidget::showHistory, this, &MainWin::showHistory);
+	QObject::connect(content_widget_, &ContentWidget::switchProject, this, &MainWin::sendProject);
+}
+
+void MainWin::ensureCentralWidget()
+{
+	if (content_widget_ != nullptr)
+		return;
+
+	// Built on first use: when starting minimized to tray, the tray icon is all that is needed at logon.
+	// Style and palettes are only needed by widgets, so they are deferred along with them.
+	QApplication::setStyle(QStyleFactory::create("Fusion"));
+	theme_.reset(new Theme(settings_));
+	QApplication::setPalette(theme_->getWindowPalette());
+	setupCentralWidget();
+	content_widget_->setGUItoMode(mode_);
+	updateHistorySummary();
+	updateProjects();
+	loadTimeline();
+}
+
+void MainWin::loadTimeline()
+{
+	const int day_start_hour = settings_.getDayStartHour();
+	const QDate today = getWorkToday(day_start_hour);
+	const qint64 day_start = getWorkDayStartMSec(today, day_start_hour);
+	const qint64 day_end = getWorkDayStartMSec(today.addDays(1), day_start_hour);
+
+	// Stopped sessions are in the archive already, only a running one has to be added
+	std::vector<TimeSegment> segments = segment_archive_.getSegments(day_start, day_end);
+	if (mode_ != TimeTracker::Mode::None)
+		for (const TimeSegment &segment : time_tracker_.getSegments())
+			if (segment.start + segment.duration > day_start)
+				segments.push_back(segment);
+	content_widget_->getTimeline()->setDay(today, day_start_hour, segments);
+	updateTimeline();
+}
+
+void MainWin::updateTimeline()
+{
+	if (content_widget_->getTimeline()->getDate() != getWorkToday(settings_.getDayStartHour())) {
+		loadTimeline();
+		return;
+	}
+
+	if (mode_ == TimeTracker::Mode::None)
+		content_widget_->getTimeline()->clearTail();
+	else
+		content_widget_->getTimeline()->setTail((mode_ == TimeTracker::Mode::Activity) ? SegmentType::Activity : SegmentType::Pause, time_tracker_.getSegmentStart(), QDateTime::currentMSecsSinceEpoch());
+}
+
+void MainWin::updateProjects()
+{
+	if (content_widget_ != nullptr)
+		content_widget_->setProjects(projects_.getNames(), time_tracker_.getProjectName());
+}
+
+void MainWin::reloadTimeline()
+{
+	if (content_widget_ != nullptr)
+		loadTimeline();
+}
+
+void MainWin::addTimelineSegment(const TimeSegment &segment)
+{
+	if (content_widget_ != nullptr)
+		content_widget_->getTimeline()->addSegment(segment);
 }
 
 void MainWin::setupIcon()
@@ -36,18 +112,96 @@ void MainWin::setupIcon()
 
 	tray_icon_ = new QSystemTrayIcon(icon, this);
 	tray_icon_->setToolTip("Timing Inactive");
+	setupTrayMenu();
 	tray_icon_->show();
 
-	QObject::connect(tray_icon_, SIGNAL(activated(QSystemTrayIcon::ActivationReason)), this, SLOT(iconActivated(QSystemTrayIcon::ActivationReason)));
+	QObject::connect(tray_icon_, &QSystemTrayIcon::activated, this, &MainWin::iconActivated);
+}
+
+void MainWin::setupTrayMenu()
+{
+	QMenu *tray_menu = new QMenu(this);
+	tray_menu->addAction("History ...", this, &MainWin::showHistory);
+	tray_menu->addAction("Reports ...", this, &MainWin::showReports);
+	tray_menu->addAction("Correct Time ...", this, &MainWin::showEditDialog);
+	tray_menu->addAction("Add Note ...", this, &MainWin::showNoteDialog);
+	tray_menu->addAction("Search Notes ...", this, &MainWin::showNoteSearch);
+	tray_icon_->setContextMenu(tray_menu);
+}
+
+void MainWin::updateAllTimes(const TimeSnapshot &times)
+{
+	if ((content_widget_ != nullptr) && isVisible()) {
+		content_widget_->setAllTimes(times.active, times.pause);
+		content_widget_->setProjectTime(times.project_active);
+		updateTimeline();
+		// All PCs Today includes the running session, so it moves along with the own Activity time
+		if (shared_history_.isEnabled() && (times.active / merged_summary_step_msec != merged_summary_step_)) {
+			merged_summary_step_ = times.active / merged_summary_step_msec;
+			updateHistorySummary();
+		}
+	}
+	updateTrayIconTooltip(times.active, times.pause);
+	updateTrayIcon(times.active);
+
+	if((mode_ == TimeTracker::Mode::Activity) && (settings_.showTooMuchActivityWarning() || settings_.showNoPauseWarning()))
+		showActivityWarnings(times.active, times.pause);
+}
+
+void MainWin::updateTrayIconTooltip(const qint64 &t_active, const qint64 &t_pause)
+{
+	QString tooltip = "µTimer:  Timing inactive";
+	if (mode_ == TimeTracker::Mode::Pause) {
+		tooltip = "µTimer:  In Pause (Overall " + convMSecToTimeStr(t_pause) + ")";
+	}
+	else if (mode_ == TimeTracker::Mode::Activity) {
+		const QString activity = convMSecToTimeStr(t_active);
+		tooltip = "µTimer:  In Activity (Overall " + convTimeStrToDurationStr(activity) + "h / " + activity + ")";
+	}
+
+	if (tray_icon_->toolTip() != tooltip)
+		tray_icon_->setToolTip(tooltip);
+}
+
+void MainWin::updateTrayIcon(const qint64 &t_active)
+{
+	if (tray_icon_renderer_.update(mode_, t_active, settings_.getDailyTargetMsec()))
+		tray_icon_->setIcon(tray_icon_renderer_.getIcon());
+}
+
+void MainWin::pressButton(Button button)
+{
+	if (content_widget_ != nullptr)
+		content_widget_->pressButton(button);
+	else
+		emit sendButtons(button);
+}
+
+void MainWin::reactOnModeChange(TimeTracker::Mode mode)
+{
+	mode_ = mode;
+	if (content_widget_ != nullptr) {
+		content_widget_->setGUItoMode(mode);
+		updateTimeline();
+	}
 }
 
-void MainWin::updateAllTimes(qint64 t_active, qint64 t_pause)
+void MainWin::updateHistorySummary()
 {
-	content_widget_->setAllTimes(t_active, t_pause);
-	tray_icon_->setToolTip(content_widget_->getTooltip());
+	if (content_widget_ == nullptr)
+		return;
 
-	if((content_widget_->isGUIinActivity()) && (settings_.showTooMuchActivityWarning() || settings_.showTooMuchActivityWarning()))
-		showActivityWarnings(t_active, t_pause);
+	const QDate today = history_store_.getToday();
+	const DayRecord week = history_store_.getRange(today.addDays(1 - today.dayOfWeek()), today);
+	const DayRecord month = history_store_.getRange(QDate(today.year(), today.month(), 1), today);
+	QString summary = "This Week " + convMSecToHoursStr(week.activity) + "h, This Month " + convMSecToHoursStr(month.activity) + "h";
+	if (shared_history_.isEnabled()) {
+		std::vector<TimeSegment> running_segments = time_tracker_.getSegments();
+		if (mode_ == TimeTracker::Mode::Activity)
+			running_segments.push_back(TimeSegment{SegmentType::Activity, time_tracker_.getSegmentStart(), QDateTime::currentMSecsSinceEpoch() - time_tracker_.getSegmentStart(), time_tracker_.getProject()});
+		summary += ", All PCs Today " + convMSecToHoursStr(shared_history_.getActivity(today, running_segments)) + "h";
+	}
+	content_widget_->setHistorySummary(summary);
 }
 
 void MainWin::showActivityWarnings(const qint64 &t_active, const qint64 &t_pause)
@@ -55,6 +209,7 @@ void MainWin::showActivityWarnings(const qint64 &t_active, const qint64 &t_pause
 	if ((!warning_activity_shown_)
 			&& (t_active > settings_.getWarnTimeActivityMsec())) {
 		warning_activity_shown_ = true;
+		emit warningShown(t_active, t_pause, time_tracker_.getProjectName());
 		showMsgBox("Total activity time: " + convMSecToTimeStr(t_active));
 	}
 
@@ -62,6 +217,7 @@ void MainWin::showActivityWarnings(const qint64 &t_active, const qint64 &t_pause
 			&& (t_active > settings_.getWarnTimeNoPauseMsec())
 			&& (t_pause < settings_.getPauseTimeForWarnTimeNoPauseMsec())) {
 		warning_pause_shown_ = true;
+		emit warningShown(t_active, t_pause, time_tracker_.getProjectName());
 		showMsgBox("Pause time: " + convMSecToTimeStr(t_pause) + "\nwith activity time: " + convMSecToTimeStr(t_active));
 	}
 }
@@ -77,26 +233,6 @@ void MainWin::showMsgBox(const QString &text)
 	msgBox.exec();
 }
 
-void MainWin::reactOnLockState(LockEvent event)
-{
-	if (settings_.isAutopauseEnabled()) {
-		if (event == LockEvent::LongOngoingLock) {
-			if (content_widget_->isGUIinActivity()) {
-				was_active_before_autopause_ = true;
-				content_widget_->setGUItoPause();
-			}
-			else {
-				was_active_before_autopause_ = false;
-			}
-		}
-		else if (event == LockEvent::Unlock) {
-			if (was_active_before_autopause_)
-				content_widget_->setGUItoActivity();
-			was_active_before_autopause_ = false;
-		}
-	}
-}
-
 void MainWin::iconActivated(QSystemTrayIcon::ActivationReason reason)
 {
 	if (reason != QSystemTrayIcon::DoubleClick)
@@ -110,10 +246,17 @@ void MainWin::iconActivated(QSystemTrayIcon::ActivationReason reason)
 
 void MainWin::showMainWin()
 {
+	ensureCentralWidget();
 	activateWindow();
 	show();
 }
 
+void MainWin::raiseMainWin()
+{
+	showMainWin();
+	raise();
+}
+
 void MainWin::minToTray()
 {
 	hide();
@@ -130,6 +273,64 @@ void MainWin::toggleAlwaysOnTopFlag()
 	setWindowFlags(windowFlags() ^ (Qt::CustomizeWindowHint | Qt::WindowStaysOnTopHint));
 }
 
+void MainWin::showReports()
+{
+	if (report_dialog_ == nullptr) {
+		ensureCentralWidget();
+		report_dialog_ = new ReportDialog(settings_, segment_archive_, this);
+	}
+	report_dialog_->show();
+	report_dialog_->activateWindow();
+}
+
+void MainWin::showHistory()
+{
+	if (history_window_ == nullptr) {
+		ensureCentralWidget();
+		history_window_ = new HistoryWindow(settings_, history_store_, segment_archive_, note_store_, *theme_, this);
+		QObject::connect(&history_store_, &HistoryStore::historyChanged, history_window_, &HistoryWindow::reload);
+	}
+	history_window_->show();
+	history_window_->activateWindow();
+}
+
+void MainWin::showEditDialog()
+{
+	if (mode_ == TimeTracker::Mode::None) {
+		showMsgBox("Time can only be corrected while the Timer is running");
+		return;
+	}
+
+	ensureCentralWidget();
+	SegmentEditDialog dialog(settings_, this);
+	if ((dialog.exec() == QDialog::Accepted) && (dialog.getFrom() < dialog.getTo()))
+		emit sendEdit(dialog.getFrom(), dialog.getTo(), dialog.getEdit());
+}
+
+void MainWin::showNoteDialog()
+{
+	if (mode_ == TimeTracker::Mode::None) {
+		showMsgBox("Notes can only be added while the Timer is running");
+		return;
+	}
+
+	ensureCentralWidget();
+	bool ok = false;
+	const QString text = QInputDialog::getText(this, "µTimer Note", "Note on the current Segment:", QLineEdit::Normal, QString(), &ok);
+	if (ok && !text.trimmed().isEmpty() && !note_store_.setNote(QDateTime::currentMSecsSinceEpoch(), text))
+		showMsgBox("The Note could not be stored");
+}
+
+void MainWin::showNoteSearch()
+{
+	if (note_search_dialog_ == nullptr) {
+		ensureCentralWidget();
+		note_search_dialog_ = new NoteSearchDialog(note_store_, this);
+	}
+	note_search_dialog_->show();
+	note_search_dialog_->activateWindow();
+}
+
 void MainWin::start()
 {
 	if (settings_.isPinnedStartEnabled())
@@ -141,7 +342,7 @@ void MainWin::start()
 		showMainWin();
 
 	if (settings_.isAutostartTimingEnabled())
-		content_widget_->pressedStartPauseButton();
+		pressButton(Button::Start);
 
 	warning_activity_shown_ = !settings_.showTooMuchActivityWarning();
 	warning_pause_shown_ = !settings_.showNoPauseWarning();
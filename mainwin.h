@@ -4,8 +4,20 @@
 #include <QMainWindow>
 #include <QSystemTrayIcon>
 #include <QString>
+#include <memory>
 #include "contentwidget.h"
 #include "settings.h"
+#include "historystore.h"
+#include "segmentarchive.h"
+#include "reportdialog.h"
+#include "historywindow.h"
+#include "projects.h"
+#include "sharedhistory.h"
+#include "notestore.h"
+#include "notesearchdialog.h"
+#include "theme.h"
+#include "trayiconrenderer.h"
+#include "timetracker.h"
 #include "types.h"
 
 class MainWin : public QMainWindow
@@ -14,33 +26,64 @@ class MainWin : public QMainWindow
 private:
 	ContentWidget *content_widget_;
 	QSystemTrayIcon *tray_icon_;
-	const Settings & settings_;
+	TrayIconRenderer tray_icon_renderer_;
+	Settings & settings_;
+	const HistoryStore & history_store_;
+	const SegmentArchive & segment_archive_;
+	const TimeTracker & time_tracker_;
+	const SharedHistory & shared_history_;
+	const Projects & projects_;
+	NoteStore & note_store_;
+	ReportDialog *report_dialog_;
+	HistoryWindow *history_window_;
+	NoteSearchDialog *note_search_dialog_;
+	std::unique_ptr<Theme> theme_;
+	TimeTracker::Mode mode_;
+	qint64 merged_summary_step_;
 
 	bool warning_activity_shown_;
 	bool warning_pause_shown_;
-	bool was_active_before_autopause_;
 
-	void updateTrayIconTooltip(QString activity, QString pause);
+	void updateTrayIconTooltip(const qint64 &t_active, const qint64 &t_pause);
+	void updateTrayIcon(const qint64 &t_active);
 	void showMsgBox(const QString &text);
 	void showMainWin();
 	void toggleAlwaysOnTopFlag();
 	void showActivityWarnings(const qint64 &t_active, const qint64 &t_pause);
 	void setupIcon();
-	void setupCentralWidget(Settings &settings);
+	void setupTrayMenu();
+	void setupCentralWidget();
+	void ensureCentralWidget();
+	void loadTimeline();
+	void updateTimeline();
 
 public:
-	explicit MainWin(Settings & settings, QWidget *parent = nullptr);
+	explicit MainWin(Settings & settings, const HistoryStore & history_store, const SegmentArchive & segment_archive, const TimeTracker & time_tracker, const SharedHistory & shared_history, const Projects & projects, NoteStore & note_store, QWidget *parent = nullptr);
 	void start();
 
 signals:
 	void sendButtons(Button button);
+	void sendEdit(qint64 from, qint64 to, SegmentEdit edit);
+	void sendProject(const QString &name);
+	void warningShown(qint64 t_active, qint64 t_pause, const QString &project);
 
 public slots:
-	void updateAllTimes(qint64 t_active, qint64 t_pause);	
+	void updateAllTimes(const TimeSnapshot &times);
+	void pressButton(Button button);
+	void reactOnModeChange(TimeTracker::Mode mode);
+	void updateHistorySummary();
+	void addTimelineSegment(const TimeSegment &segment);
+	void reloadTimeline();
+	void updateProjects();
 	void iconActivated(QSystemTrayIcon::ActivationReason reason);
 	void minToTray();
+	void raiseMainWin();
 	void toggleAlwaysOnTop();
-	void reactOnLockState(LockEvent event);
+	void showReports();
+	void showHistory();
+	void showEditDialog();
+	void showNoteDialog();
+	void showNoteSearch();
 };
 
 #endif // MAINWIN_H
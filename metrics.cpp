@@ -0,0 +1,73 @@
+#include "metrics.h"
+#include <atomic>
+#include <array>
+
+namespace {
+
+struct CounterInfo {
+	const char *name;
+	const char *help;
+};
+
+const size_t counter_count = 7;
+const size_t tick_latency_bucket_count = 8;
+
+const std::array<CounterInfo, counter_count> counter_infos = {{
+	{ "utimer_lock_query_failures_total", "Lock state queries that failed and were treated as unlocked" },
+	{ "utimer_autopauses_total", "Retroactive pauses started by a lock or input idle" },
+	{ "utimer_event_loop_stalls_total", "Ticks that arrived far later than their interval" },
+	{ "utimer_event_loop_stall_msec_total", "Time the event loop was stalled, summed over all stalls" },
+	{ "utimer_log_lines_total", "Lines written to the log file" },
+	{ "utimer_log_bytes_total", "Bytes written to the log file" },
+	{ "utimer_control_requests_total", "Requests received on the control socket" }
+}};
+
+const std::array<qint64, tick_latency_bucket_count> tick_latency_bounds = {{ 1, 5, 10, 50, 100, 500, 1000, 5000 }};
+
+std::array<std::atomic<quint64>, counter_count> counters{};
+std::array<std::atomic<quint64>, tick_latency_bucket_count + 1> tick_latency_buckets{};
+std::atomic<quint64> tick_latency_sum{0};
+
+}
+
+void Metrics::count(const Counter counter, const quint64 value /* =1 */)
+{
+	counters[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void Metrics::observeTickLatency(const qint64 t_msec)
+{
+	const qint64 t_late = qMax(Q_INT64_C(0), t_msec);
+	size_t bucket = 0;
+	while ((bucket < tick_latency_bounds.size()) && (t_late > tick_latency_bounds[bucket]))
+		++bucket;
+	tick_latency_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	tick_latency_sum.fetch_add(static_cast<quint64>(t_late), std::memory_order_relaxed);
+}
+
+QByteArray Metrics::getExposition()
+{
+	QByteArray text;
+
+	for (size_t i = 0; i < counter_infos.size(); ++i) {
+		const QByteArray name(counter_infos[i].name);
+		text += "# HELP " + name + ' ' + counter_infos[i].help + '\n';
+		text += "# TYPE " + name + " counter\n";
+		text += name + ' ' + QByteArray::number(counters[i].load(std::memory_order_relaxed)) + '\n';
+	}
+
+	// Buckets are stored individually and only made cumulative here
+	const QByteArray name("utimer_tick_latency_msec");
+	text += "# HELP " + name + " How much later than its interval each tick arrived\n";
+	text += "# TYPE " + name + " histogram\n";
+	quint64 cumulative = 0;
+	for (size_t i = 0; i < tick_latency_buckets.size(); ++i) {
+		cumulative += tick_latency_buckets[i].load(std::memory_order_relaxed);
+		const QByteArray bound = (i < tick_latency_bounds.size()) ? QByteArray::number(tick_latency_bounds[i]) : QByteArray("+Inf");
+		text += name + "_bucket{le=\"" + bound + "\"} " + QByteArray::number(cumulative) + '\n';
+	}
+	text += name + "_sum " + QByteArray::number(tick_latency_sum.load(std::memory_order_relaxed)) + '\n';
+	text += name + "_count " + QByteArray::number(cumulative) + '\n';
+
+	return text;
+}
@@ -0,0 +1,22 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+// Process wide counters and histograms. Updating is a single relaxed atomic add, so it is safe and
+// cheap from any hot path; only rendering the text exposition for a scrape walks over all of them.
+class Metrics
+{
+public:
+	enum class Counter {LockQueryFailures, Autopauses, EventLoopStalls, EventLoopStallMsec, LogLines, LogBytes, ControlRequests};
+
+	static void count(const Counter counter, const quint64 value = 1);
+	static void observeTickLatency(const qint64 t_msec);
+	static QByteArray getExposition();
+
+private:
+	Metrics() = delete;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,62 @@
+#include "metricsserver.h"
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QByteArray>
+#include <QList>
+#include "metrics.h"
+#include "logger.h"
+
+namespace {
+	const qint64 max_request_length = 8192;
+}
+
+MetricsServer::MetricsServer(const Settings &settings, QObject *parent)
+	: QObject(parent),
+		settings_(settings)
+{
+	QObject::connect(&server_, &QTcpServer::newConnection, this, &MetricsServer::acceptConnections);
+
+	if (!server_.listen(QHostAddress::LocalHost, settings_.getMetricsPort())) {
+		if (settings_.logToFile())
+			Logger::Log("[METRICS] Could not listen on Port " + QString::number(settings_.getMetricsPort()) + ": " + server_.errorString());
+	}
+	else if (settings_.logToFile()) {
+		Logger::Log("[METRICS] Serving Metrics on http://127.0.0.1:" + QString::number(settings_.getMetricsPort()) + "/metrics");
+	}
+}
+
+void MetricsServer::acceptConnections()
+{
+	while (QTcpSocket *socket = server_.nextPendingConnection()) {
+		QObject::connect(socket, &QIODevice::readyRead, this, &MetricsServer::answerRequest);
+		QObject::connect(socket, &QAbstractSocket::disconnected, socket, &QObject::deleteLater);
+	}
+}
+
+void MetricsServer::answerRequest()
+{
+	QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+	if (socket == nullptr)
+		return;
+
+	// Only the request line matters, but the answer waits for the complete header
+	const QByteArray request = socket->peek(max_request_length);
+	if (!request.contains("\r\n\r\n")) {
+		if (socket->bytesAvailable() >= max_request_length)
+			socket->abort();
+		return;
+	}
+	socket->readAll();
+
+	const QList<QByteArray> request_line = request.left(request.indexOf("\r\n")).split(' ');
+	const bool is_metrics_request = (request_line.size() >= 2) && (request_line[0] == "GET") && (request_line[1] == "/metrics");
+
+	const QByteArray body = is_metrics_request ? Metrics::getExposition() : QByteArray("Not Found\n");
+	const QByteArray status = is_metrics_request ? "200 OK" : "404 Not Found";
+	socket->write("HTTP/1.1 " + status + "\r\n"
+								+ "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+								+ "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+								+ "Connection: close\r\n\r\n"
+								+ body);
+	socket->disconnectFromHost();
+}
@@ -0,0 +1,25 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include "settings.h"
+
+
+class MetricsServer : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QTcpServer server_;
+
+private slots:
+	void acceptConnections();
+	void answerRequest();
+
+public:
+	explicit MetricsServer(const Settings & settings, QObject *parent = nullptr);
+};
+
+#endif // METRICSSERVER_H
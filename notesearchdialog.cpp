@@ -0,0 +1,40 @@
+#include "notesearchdialog.h"
+#include <QVBoxLayout>
+#include <QDateTime>
+
+namespace {
+	const size_t max_results = 100;
+}
+
+NoteSearchDialog::NoteSearchDialog(NoteStore &note_store, QWidget *parent)
+	: QDialog(parent),
+		note_store_(note_store)
+{
+	setWindowTitle("µTimer Notes");
+	setupGUI();
+
+	QObject::connect(query_edit_, &QLineEdit::textChanged, this, &NoteSearchDialog::search);
+	QObject::connect(&note_store_, &NoteStore::notesChanged, this, &NoteSearchDialog::search);
+}
+
+void NoteSearchDialog::setupGUI()
+{
+	QVBoxLayout *rows = new QVBoxLayout(this);
+
+	query_edit_ = new QLineEdit();
+	query_edit_->setPlaceholderText("Words to search for");
+	query_edit_->setClearButtonEnabled(true);
+
+	result_list_ = new QListWidget();
+	result_list_->setMinimumWidth(320);
+
+	rows->addWidget(query_edit_);
+	rows->addWidget(result_list_);
+}
+
+void NoteSearchDialog::search()
+{
+	result_list_->clear();
+	for (const NoteStore::Note &note : note_store_.search(query_edit_->text(), max_results))
+		result_list_->addItem(QDateTime::fromMSecsSinceEpoch(note.time).toString("yyyy-MM-dd hh:mm") + "  " + note.text);
+}
@@ -0,0 +1,29 @@
+#ifndef NOTESEARCHDIALOG_H
+#define NOTESEARCHDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QString>
+#include "notestore.h"
+
+// Searches all notes while typing; notes are only read when this is opened the first time
+class NoteSearchDialog : public QDialog
+{
+	Q_OBJECT
+
+private:
+	NoteStore & note_store_;
+	QLineEdit *query_edit_;
+	QListWidget *result_list_;
+
+	void setupGUI();
+
+public:
+	explicit NoteSearchDialog(NoteStore & note_store, QWidget *parent = nullptr);
+
+public slots:
+	void search();
+};
+
+#endif // NOTESEARCHDIALOG_H
@@ -0,0 +1,176 @@
+#include "notestore.h"
+#include <QDateTime>
+#include <QRegularExpression>
+#include <algorithm>
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	const int max_note_length = 200;
+	const QRegularExpression word_separator("\\W+", QRegularExpression::UseUnicodePropertiesOption);
+}
+
+NoteStore::NoteStore(const Settings &settings, const QString &filename, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		file_(filename),
+		loaded_(false)
+{ }
+
+void NoteStore::ensureLoaded()
+{
+	if (loaded_)
+		return;
+	loaded_ = true;
+
+	if (!file_.exists())
+		return;
+	if (!file_.open(QIODevice::ReadOnly)) {
+		if (settings_.logToFile())
+			Logger::Log("[NOTE] Could not read " + file_.fileName());
+		return;
+	}
+
+	// One "<msec since epoch><tab><text>" line per note
+	while (!file_.atEnd()) {
+		QByteArray line = file_.readLine();
+		while (line.endsWith('\n') || line.endsWith('\r'))
+			line.chop(1);
+		const int tab = line.indexOf('\t');
+		bool ok = false;
+		const qint64 time = (tab > 0) ? line.left(tab).toLongLong(&ok) : 0;
+		if (ok)
+			putNote(time, QString::fromUtf8(line.mid(tab + 1)));
+	}
+	file_.close();
+
+	if (settings_.logToFile())
+		Logger::Log("[NOTE] Loaded " + QString::number(notes_.size()) + " Notes with " + QString::number(index_.size()) + " Words");
+}
+
+void NoteStore::putNote(const qint64 time, const QString &text)
+{
+	// Replaced words are left in the index, lookups check the note itself anyway
+	if (text.isEmpty()) {
+		notes_.erase(time);
+		return;
+	}
+	notes_[time] = text;
+	for (const QString &word : getWords(text))
+		addPosting(index_[word], time);
+}
+
+QStringList NoteStore::getWords(const QString &text)
+{
+	QStringList words = text.toLower().split(word_separator, QString::SkipEmptyParts);
+	words.removeDuplicates();
+	return words;
+}
+
+void NoteStore::addPosting(Postings &postings, const qint64 time)
+{
+	if (postings.deltas.isEmpty() || (time > postings.last)) {
+		putVarint(postings.deltas, static_cast<quint64>(time - (postings.deltas.isEmpty() ? 0 : postings.last)));
+		postings.last = time;
+		return;
+	}
+
+	// Only a note on an older segment ends up here, so re-encoding the whole list is rare
+	std::vector<qint64> times = getPostings(postings);
+	const auto position = std::lower_bound(times.begin(), times.end(), time);
+	if ((position != times.end()) && (*position == time))
+		return;
+	times.insert(position, time);
+
+	postings.deltas.clear();
+	qint64 previous = 0;
+	for (const qint64 t : times) {
+		putVarint(postings.deltas, static_cast<quint64>(t - previous));
+		previous = t;
+	}
+	postings.last = times.back();
+}
+
+std::vector<qint64> NoteStore::getPostings(const Postings &postings)
+{
+	std::vector<qint64> times;
+	const uchar *pos = reinterpret_cast<const uchar*>(postings.deltas.constData());
+	const uchar * const end = pos + postings.deltas.size();
+	qint64 time = 0;
+	quint64 delta = 0;
+	while ((pos < end) && getVarint(pos, end, delta)) {
+		time += static_cast<qint64>(delta);
+		times.push_back(time);
+	}
+	return times;
+}
+
+std::vector<NoteStore::Note> NoteStore::search(const QString &query, const size_t max_results)
+{
+	ensureLoaded();
+	std::vector<Note> results;
+	const QStringList words = getWords(query);
+	if (words.isEmpty())
+		return results;
+
+	// Candidates come from the shortest list; checking them against the note text covers the other
+	// words and drops times whose note has been changed since
+	const Postings *shortest = nullptr;
+	for (const QString &word : words) {
+		const auto postings = index_.constFind(word);
+		if (postings == index_.constEnd())
+			return results;
+		if ((shortest == nullptr) || (postings->deltas.size() < shortest->deltas.size()))
+			shortest = &postings.value();
+	}
+
+	const std::vector<qint64> candidates = getPostings(*shortest);
+	for (auto time = candidates.rbegin(); (time != candidates.rend()) && (results.size() < max_results); ++time) {
+		const auto note = notes_.find(*time);
+		if (note == notes_.end())
+			continue;
+		const QStringList note_words = getWords(note->second);
+		if (std::all_of(words.begin(), words.end(), [&note_words](const QString &word) { return note_words.contains(word); }))
+			results.push_back(Note{note->first, note->second});
+	}
+	return results;
+}
+
+std::vector<NoteStore::Note> NoteStore::getNotes(const qint64 from, const qint64 to)
+{
+	ensureLoaded();
+	std::vector<Note> notes;
+	for (auto note = notes_.lower_bound(from); (note != notes_.end()) && (note->first < to); ++note)
+		notes.push_back(Note{note->first, note->second});
+	return notes;
+}
+
+bool NoteStore::setNote(const qint64 time, const QString &text)
+{
+	if (time <= 0)
+		return false;
+
+	// Only a stored note is shown, so nothing claims a note that is gone after a restart
+	const QString clean_text = text.simplified().left(max_note_length);
+	const QByteArray line = QByteArray::number(time) + '\t' + clean_text.toUtf8() + '\n';
+	bool stored = file_.open(QIODevice::WriteOnly | QIODevice::Append);
+	if (stored) {
+		const qint64 size = file_.size();
+		stored = (file_.write(line) == line.size()) && file_.flush();
+		if (!stored)
+			file_.resize(size);
+	}
+	file_.close();
+	if (!stored) {
+		if (settings_.logToFile())
+			Logger::Log("[NOTE] Could not store Note");
+		return false;
+	}
+
+	if (loaded_)
+		putNote(time, clean_text);
+	if (settings_.logToFile())
+		Logger::Log("[NOTE] Note set at " + QDateTime::fromMSecsSinceEpoch(time).toString(Qt::ISODate));
+	emit notesChanged();
+	return true;
+}
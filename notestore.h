@@ -0,0 +1,59 @@
+#ifndef NOTESTORE_H
+#define NOTESTORE_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <vector>
+#include "settings.h"
+
+// Short notes on segments, e.g. "code review". A note is stored with a time and belongs to the segment
+// containing that time, so it survives segments being merged or split by corrections. The file is only
+// appended to; a later note for the same time replaces an earlier one and an empty one removes it.
+// Notes and the word index are only read on the first lookup, adding a note just appends a line.
+class NoteStore : public QObject
+{
+	Q_OBJECT
+
+public:
+	struct Note
+	{
+		qint64 time;	// msec since epoch
+		QString text;
+	};
+
+private:
+	struct Postings
+	{
+		QByteArray deltas;	// ascending note times as varint deltas
+		qint64 last;
+	};
+
+	const Settings & settings_;
+	QFile file_;
+	bool loaded_;
+	std::map<qint64, QString> notes_;	// by time
+	QHash<QString, Postings> index_;	// by word; may still list times whose note has changed since
+
+	void ensureLoaded();
+	void putNote(const qint64 time, const QString &text);
+	static QStringList getWords(const QString &text);
+	static void addPosting(Postings &postings, const qint64 time);
+	static std::vector<qint64> getPostings(const Postings &postings);
+
+public:
+	explicit NoteStore(const Settings & settings, const QString &filename, QObject *parent = nullptr);
+	std::vector<Note> search(const QString &query, const size_t max_results);
+	std::vector<Note> getNotes(const qint64 from, const qint64 to);
+	bool setNote(const qint64 time, const QString &text);
+
+signals:
+	void notesChanged();
+};
+
+#endif // NOTESTORE_H
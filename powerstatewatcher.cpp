@@ -0,0 +1,103 @@
+#include "powerstatewatcher.h"
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include "logger.h"
+
+namespace {
+	const DWORD device_notify_callback = 2; // DEVICE_NOTIFY_CALLBACK, powrprof.h only declares it for Windows 8 and later
+}
+
+PowerStateWatcher::PowerStateWatcher(const Settings &settings, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		powrprof_lib_(nullptr),
+		registration_handle_(nullptr),
+		subscribe_parameters_{ &PowerStateWatcher::powerCallback, this },
+		suspended_(false),
+		suspend_mono_(0),
+		suspend_ticks_(0)
+{
+	registerPowerNotification();
+}
+
+PowerStateWatcher::~PowerStateWatcher()
+{
+	unregisterPowerNotification();
+}
+
+void PowerStateWatcher::registerPowerNotification()
+{
+	// Loaded at runtime like wtsapi32.dll in LockStateWatcher, so the app still starts where the API is missing
+	typedef DWORD ( WINAPI * PowerRegisterSuspendResumeNotification )( DWORD Flags, HANDLE Recipient, PVOID* RegistrationHandle );
+
+	powrprof_lib_ = LoadLibraryW(L"powrprof.dll");
+	if (!powrprof_lib_) {
+		if (settings_.logToFile())
+			Logger::Log("[POWER] Could not load powrprof.dll, Sleep will not be detected");
+		return;
+	}
+
+	PowerRegisterSuspendResumeNotification pRegister = reinterpret_cast<PowerRegisterSuspendResumeNotification>(GetProcAddress(powrprof_lib_, "PowerRegisterSuspendResumeNotification"));
+	if ((pRegister == nullptr) || (pRegister(device_notify_callback, &subscribe_parameters_, &registration_handle_) != ERROR_SUCCESS)) {
+		registration_handle_ = nullptr;
+		FreeLibrary(powrprof_lib_);
+		powrprof_lib_ = nullptr;
+		if (settings_.logToFile())
+			Logger::Log("[POWER] Could not register for Suspend/Resume Notifications, Sleep will not be detected");
+	}
+}
+
+void PowerStateWatcher::unregisterPowerNotification()
+{
+	typedef DWORD ( WINAPI * PowerUnregisterSuspendResumeNotification )( PVOID RegistrationHandle );
+
+	if (powrprof_lib_ == nullptr)
+		return;
+
+	PowerUnregisterSuspendResumeNotification pUnregister = reinterpret_cast<PowerUnregisterSuspendResumeNotification>(GetProcAddress(powrprof_lib_, "PowerUnregisterSuspendResumeNotification"));
+	if ((pUnregister != nullptr) && (registration_handle_ != nullptr))
+		pUnregister(registration_handle_);
+	registration_handle_ = nullptr;
+	FreeLibrary(powrprof_lib_);
+	powrprof_lib_ = nullptr;
+}
+
+ULONG CALLBACK PowerStateWatcher::powerCallback(PVOID context, ULONG type, PVOID /* setting */)
+{
+	// Runs on a system thread and the system may sleep right after returning, so the exact
+	// boundary is taken here and handed to the GUI thread, which can only react after the resume.
+	// QElapsedTimer may or may not count through the sleep, GetTickCount64() always does.
+	QElapsedTimer now;
+	now.start();
+	const qint64 t_mono = now.msecsSinceReference();
+	const qint64 t_ticks = static_cast<qint64>(GetTickCount64());
+
+	PowerStateWatcher *watcher = static_cast<PowerStateWatcher*>(context);
+	if (type == PBT_APMSUSPEND)
+		QMetaObject::invokeMethod(watcher, "registerSuspend", Qt::QueuedConnection, Q_ARG(qint64, t_mono), Q_ARG(qint64, t_ticks));
+	else if (type == PBT_APMRESUMEAUTOMATIC)
+		QMetaObject::invokeMethod(watcher, "registerResume", Qt::QueuedConnection, Q_ARG(qint64, t_mono), Q_ARG(qint64, t_ticks));
+
+	return ERROR_SUCCESS;
+}
+
+void PowerStateWatcher::registerSuspend(qint64 t_mono, qint64 t_ticks)
+{
+	suspended_ = true;
+	suspend_mono_ = t_mono;
+	suspend_ticks_ = t_ticks;
+	if (settings_.logToFile())
+		Logger::Log("[POWER] >> System going to Sleep");
+}
+
+void PowerStateWatcher::registerResume(qint64 t_mono, qint64 t_ticks)
+{
+	if (!suspended_)
+		return;
+
+	suspended_ = false;
+	const qint64 t_sleep = qMax(Q_INT64_C(0), t_ticks - suspend_ticks_);
+	if (settings_.logToFile())
+		Logger::Log("[POWER] System resumed from Sleep <<, Sleep Duration = " + QString::number(t_sleep) + "ms");
+	emit systemSlept(suspend_mono_, t_mono, t_sleep);
+}
@@ -0,0 +1,45 @@
+#ifndef POWERSTATEWATCHER_H
+#define POWERSTATEWATCHER_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <Windows.h>
+#include "settings.h"
+
+
+class PowerStateWatcher : public QObject
+{
+	Q_OBJECT
+
+private:
+	typedef ULONG ( CALLBACK * PowerNotifyCallback )( PVOID Context, ULONG Type, PVOID Setting );
+	struct PowerNotifySubscribeParameters {
+		PowerNotifyCallback Callback;
+		PVOID Context;
+	};
+
+	const Settings & settings_;
+	HMODULE powrprof_lib_;
+	PVOID registration_handle_;
+	PowerNotifySubscribeParameters subscribe_parameters_;
+	bool suspended_;
+	qint64 suspend_mono_;
+	qint64 suspend_ticks_;
+
+	void registerPowerNotification();
+	void unregisterPowerNotification();
+	static ULONG CALLBACK powerCallback(PVOID context, ULONG type, PVOID setting);
+
+private slots:
+	void registerSuspend(qint64 t_mono, qint64 t_ticks);
+	void registerResume(qint64 t_mono, qint64 t_ticks);
+
+public:
+	explicit PowerStateWatcher(const Settings & settings, QObject *parent = nullptr);
+	~PowerStateWatcher();
+
+signals:
+	void systemSlept(qint64 t_mono_suspend, qint64 t_mono_resume, qint64 t_sleep);
+};
+
+#endif // POWERSTATEWATCHER_H
@@ -0,0 +1,79 @@
+#include "projects.h"
+#include "logger.h"
+
+namespace {
+	const QString default_project = "Default";
+	const int max_name_length = 64;
+}
+
+Projects::Projects(const Settings &settings, const QString &filename, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		file_(filename)
+{
+	quint16 id = 0;
+	names_.intern(default_project, id);
+	readFile();
+}
+
+void Projects::readFile()
+{
+	if (!file_.exists())
+		return;
+	if (!file_.open(QIODevice::ReadOnly)) {
+		if (settings_.logToFile())
+			Logger::Log("[PROJECT] Could not read " + file_.fileName());
+		return;
+	}
+
+	quint16 id = 0;
+	while (!file_.atEnd()) {
+		const QString name = QString::fromUtf8(file_.readLine()).trimmed();
+		if (!name.isEmpty() && !names_.intern(name, id))
+			break;
+	}
+	file_.close();
+}
+
+bool Projects::getId(const QString &name, quint16 &id)
+{
+	const QString clean_name = name.simplified().left(max_name_length);
+	if (clean_name.isEmpty())
+		return false;
+	if (names_.find(clean_name, id))
+		return true;
+
+	// Ids are positions in the file, so a name only gets its id once it is stored there
+	const QByteArray line = clean_name.toUtf8() + '\n';
+	bool stored = file_.open(QIODevice::WriteOnly | QIODevice::Append);
+	if (stored) {
+		const qint64 size = file_.size();
+		stored = (file_.write(line) == line.size()) && file_.flush();
+		if (!stored)
+			file_.resize(size);
+	}
+	file_.close();
+	if (!stored) {
+		if (settings_.logToFile())
+			Logger::Log("[PROJECT] Could not store Project '" + clean_name + "'");
+		return false;
+	}
+	if (!names_.intern(clean_name, id))
+		return false;
+
+	emit projectAdded(clean_name);
+	return true;
+}
+
+QString Projects::getName(const quint16 id) const
+{
+	return names_.getString(id);
+}
+
+QStringList Projects::getNames() const
+{
+	QStringList names;
+	for (size_t id = 0; id < names_.size(); ++id)
+		names << names_.getString(static_cast<quint16>(id));
+	return names;
+}
@@ -0,0 +1,35 @@
+#ifndef PROJECTS_H
+#define PROJECTS_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include "settings.h"
+#include "stringinterner.h"
+
+// All project names ever used. A project's id is its position in the file, so ids stored with segments
+// stay valid; the file is only ever appended to. Id 0 is the default project.
+class Projects : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QFile file_;
+	StringInterner names_;
+
+	void readFile();
+
+public:
+	explicit Projects(const Settings & settings, const QString &filename, QObject *parent = nullptr);
+	bool getId(const QString &name, quint16 &id);
+	QString getName(const quint16 id) const;
+	QStringList getNames() const;
+
+signals:
+	void projectAdded(const QString &name);
+};
+
+#endif // PROJECTS_H
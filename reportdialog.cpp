@@ -0,0 +1,155 @@
+#include "reportdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFont>
+#include <QApplication>
+#include <QLocale>
+#include <QStringList>
+#include <algorithm>
+#include <array>
+#include "helpers.h"
+
+namespace {
+	const int busiest_hour_count = 3;
+	const std::array<const char*, 6> pause_length_names = {{ "< 5m", "5-15m", "15-30m", "30-60m", "1-2h", "> 2h" }};
+}
+
+ReportDialog::ReportDialog(const Settings &settings, const SegmentArchive &segment_archive, QWidget *parent)
+	: QDialog(parent),
+		settings_(settings),
+		report_engine_(settings, segment_archive)
+{
+	setWindowTitle("µTimer Reports");
+	setupGUI();
+
+	QObject::connect(week_button_, &QAbstractButton::clicked, this, &ReportDialog::showWeekReport);
+	QObject::connect(month_button_, &QAbstractButton::clicked, this, &ReportDialog::showMonthReport);
+	QObject::connect(year_button_, &QAbstractButton::clicked, this, &ReportDialog::showYearReport);
+	QObject::connect(cancel_button_, &QAbstractButton::clicked, this, &ReportDialog::cancelReport);
+	QObject::connect(this, &QDialog::rejected, this, &ReportDialog::cancelReport);
+
+	QObject::connect(&report_engine_, &ReportEngine::progressRangeChanged, progress_bar_, &QProgressBar::setRange);
+	QObject::connect(&report_engine_, &ReportEngine::progressValueChanged, progress_bar_, &QProgressBar::setValue);
+	QObject::connect(&report_engine_, &ReportEngine::reportReady, this, &ReportDialog::displayReport);
+	QObject::connect(&report_engine_, &ReportEngine::reportCanceled, this, &ReportDialog::displayCanceled);
+}
+
+void ReportDialog::setupGUI()
+{
+	QFont button_font = QApplication::font();
+	button_font.setPointSize(8);
+
+	QVBoxLayout *rows = new QVBoxLayout(this);
+
+	// [This Week] [This Month] [This Year]
+	QHBoxLayout *period_row = new QHBoxLayout();
+	week_button_ = new QPushButton("This Week");
+	week_button_->setFont(button_font);
+	month_button_ = new QPushButton("This Month");
+	month_button_->setFont(button_font);
+	year_button_ = new QPushButton("This Year");
+	year_button_->setFont(button_font);
+	period_row->addWidget(week_button_);
+	period_row->addWidget(month_button_);
+	period_row->addWidget(year_button_);
+
+	// [=====     ] [Cancel]
+	QHBoxLayout *progress_row = new QHBoxLayout();
+	progress_bar_ = new QProgressBar();
+	progress_bar_->setRange(0, 1);
+	progress_bar_->setValue(0);
+	cancel_button_ = new QPushButton("Cancel");
+	cancel_button_->setFont(button_font);
+	cancel_button_->setEnabled(false);
+	progress_row->addWidget(progress_bar_);
+	progress_row->addWidget(cancel_button_);
+
+	report_text_ = new QLabel("Choose a Period");
+	report_text_->setTextInteractionFlags(Qt::TextSelectableByMouse);
+	report_text_->setMinimumWidth(260);
+
+	rows->addLayout(period_row);
+	rows->addLayout(progress_row);
+	rows->addWidget(report_text_);
+}
+
+void ReportDialog::startReport(const QDate &first, const QDate &last)
+{
+	report_text_->setText("Building Report ...");
+	cancel_button_->setEnabled(true);
+	report_engine_.start(first, last);
+}
+
+void ReportDialog::showWeekReport()
+{
+	const QDate today = getWorkToday(settings_.getDayStartHour());
+	startReport(today.addDays(1 - today.dayOfWeek()), today);
+}
+
+void ReportDialog::showMonthReport()
+{
+	const QDate today = getWorkToday(settings_.getDayStartHour());
+	startReport(QDate(today.year(), today.month(), 1), today);
+}
+
+void ReportDialog::showYearReport()
+{
+	const QDate today = getWorkToday(settings_.getDayStartHour());
+	startReport(QDate(today.year(), 1, 1), today);
+}
+
+void ReportDialog::cancelReport()
+{
+	report_engine_.cancel();
+}
+
+void ReportDialog::displayReport(const Report &report)
+{
+	cancel_button_->setEnabled(false);
+	progress_bar_->setRange(0, 1);
+	progress_bar_->setValue(1);
+
+	const QString overtime_sign = (report.overtime < 0) ? "-" : "+";
+	report_text_->setText(report.first.toString(Qt::ISODate) + " - " + report.last.toString(Qt::ISODate) + "\n\n"
+		+ "Activity:\t" + convMSecToHoursStr(report.activity) + "h\n"
+		+ "Pause:\t" + convMSecToHoursStr(report.pause) + "h\n"
+		+ "Days worked:\t" + QString::number(report.days_worked) + "\n"
+		+ "Average per Day:\t" + convMSecToHoursStr(report.average_activity) + "h\n"
+		+ "Overtime:\t" + overtime_sign + convMSecToHoursStr(qAbs(report.overtime)) + "h\n"
+		+ "Longest Stretch:\t" + convMSecToHoursStr(report.longest_stretch) + "h\n"
+		+ "Auto-Pauses:\t" + QString::number(report.autopauses) + "\n\n"
+		+ getStatisticsText(report.statistics));
+}
+
+QString ReportDialog::getStatisticsText(const SegmentStatistics &statistics) const
+{
+	const QLocale locale;
+	QStringList weekdays;
+	for (size_t day = 0; day < statistics.activity_per_weekday.size(); ++day)
+		weekdays << locale.dayName(static_cast<int>(day) + 1, QLocale::ShortFormat) + " " + convMSecToHoursStr(statistics.activity_per_weekday[day]) + "h";
+
+	std::array<size_t, 24> hours;
+	for (size_t hour = 0; hour < hours.size(); ++hour)
+		hours[hour] = hour;
+	std::stable_sort(hours.begin(), hours.end(), [&statistics](const size_t a, const size_t b) {
+		return (statistics.activity_per_hour[a] > statistics.activity_per_hour[b]);
+	});
+	QStringList busiest_hours;
+	for (int i = 0; (i < busiest_hour_count) && (statistics.activity_per_hour[hours[i]] > 0); ++i)
+		busiest_hours << QString("%1-%2").arg(hours[i], 2, 10, QChar('0')).arg(hours[i] + 1, 2, 10, QChar('0'));
+
+	QStringList pauses;
+	for (size_t bucket = 0; bucket < pause_length_names.size(); ++bucket)
+		pauses << QString(pause_length_names[bucket]) + ": " + QString::number(statistics.pause_count_by_length[bucket]);
+
+	return ("Activity per Weekday:\n" + weekdays.join("  ") + "\n"
+		+ "Busiest Hours:\t" + (busiest_hours.isEmpty() ? QString("-") : busiest_hours.join(", ")) + "\n"
+		+ "Pauses by Length:\n" + pauses.join("  "));
+}
+
+void ReportDialog::displayCanceled()
+{
+	cancel_button_->setEnabled(false);
+	progress_bar_->setValue(progress_bar_->minimum());
+	report_text_->setText("Report canceled");
+}
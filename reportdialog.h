@@ -0,0 +1,47 @@
+#ifndef REPORTDIALOG_H
+#define REPORTDIALOG_H
+
+#include <QDialog>
+#include <QDate>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QString>
+#include "settings.h"
+#include "segmentarchive.h"
+#include "reportengine.h"
+
+// Weekly, monthly and yearly reports; the engine works in the background, so the timer keeps running
+// and the dialog stays responsive while a report is built
+class ReportDialog : public QDialog
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	ReportEngine report_engine_;
+
+	QPushButton *week_button_;
+	QPushButton *month_button_;
+	QPushButton *year_button_;
+	QPushButton *cancel_button_;
+	QProgressBar *progress_bar_;
+	QLabel *report_text_;
+
+	void setupGUI();
+	void startReport(const QDate &first, const QDate &last);
+	QString getStatisticsText(const SegmentStatistics &statistics) const;
+
+public:
+	explicit ReportDialog(const Settings & settings, const SegmentArchive & segment_archive, QWidget *parent = nullptr);
+
+public slots:
+	void showWeekReport();
+	void showMonthReport();
+	void showYearReport();
+	void cancelReport();
+	void displayReport(const Report &report);
+	void displayCanceled();
+};
+
+#endif // REPORTDIALOG_H
@@ -0,0 +1,206 @@
+#include "reportengine.h"
+#include <QDateTime>
+#include <QTime>
+#include <QFile>
+#include <QString>
+#include <QtConcurrent>
+#include <vector>
+#include "historystore.h"
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	struct ReportChunk
+	{
+		QString filename;
+		SegmentBlock block;
+		qint64 from;
+		qint64 to;
+		int day_start_hour;
+	};
+
+	// Runs on a worker thread, so it only touches its own copy of the chunk and its own file handle
+	ReportData aggregateChunk(const ReportChunk &chunk)
+	{
+		ReportData data;
+		QFile file(chunk.filename);
+		SegmentColumns columns;
+		if (!file.open(QIODevice::ReadOnly) || !SegmentArchive::readBlock(file, chunk.block, columns))
+			return data;
+		SegmentArchive::addStatistics(columns, chunk.from, chunk.to, data.statistics);
+
+		qint64 stretch = 0;
+		qint64 stretch_end = 0;
+		bool leading = true;
+		for (size_t i = 0; i < columns.size(); ++i) {
+			const qint64 start = columns.starts[i];
+			const qint64 duration = columns.durations[i];
+			if ((start < chunk.from) || (start >= chunk.to))
+				continue;
+
+			const SegmentType type = static_cast<SegmentType>(columns.types[i]);
+			if (type == SegmentType::Activity) {
+				data.activity_per_day[HistoryStore::getDayNumber(start, chunk.day_start_hour)] += duration;
+				// Activities of consecutive sessions without a gap count as one stretch
+				if (data.empty)
+					data.leading_start = start;
+				else if ((stretch == 0) || (start != stretch_end))
+					leading = false;
+				stretch = ((stretch > 0) && (start == stretch_end)) ? (stretch + duration) : duration;
+				stretch_end = start + duration;
+				if (leading)
+					data.leading_stretch = stretch;
+				data.longest_stretch = qMax(data.longest_stretch, stretch);
+			}
+			else {
+				data.pause += duration;
+				stretch = 0;
+				stretch_end = 0;
+				leading = false;
+				if (type == SegmentType::Autopause)
+					++data.autopauses;
+			}
+			data.empty = false;
+		}
+		data.unbroken = (!data.empty && leading);
+		data.trailing_end = stretch_end;
+		data.trailing_stretch = stretch;
+		return data;
+	}
+
+	void mergeChunk(ReportData &result, const ReportData &data)
+	{
+		result.merge(data);
+	}
+}
+
+ReportData::ReportData()
+	: pause(0), longest_stretch(0), autopauses(0), empty(true), unbroken(false),
+		leading_start(0), leading_stretch(0), trailing_end(0), trailing_stretch(0)
+{
+}
+
+void ReportData::merge(const ReportData &other)
+{
+	// other has to follow this in time
+	if (other.empty)
+		return;
+	if (empty) {
+		*this = other;
+		return;
+	}
+
+	for (const auto &day : other.activity_per_day)
+		activity_per_day[day.first] += day.second;
+	pause += other.pause;
+	autopauses += other.autopauses;
+	statistics.add(other.statistics);
+
+	const bool joined = (trailing_stretch > 0) && (other.leading_stretch > 0) && (other.leading_start == trailing_end);
+	const qint64 joined_stretch = joined ? (trailing_stretch + other.leading_stretch) : 0;
+	longest_stretch = qMax(qMax(longest_stretch, other.longest_stretch), joined_stretch);
+	if (unbroken && joined)
+		leading_stretch = joined_stretch;
+	trailing_stretch = (other.unbroken && joined) ? joined_stretch : other.trailing_stretch;
+	trailing_end = other.trailing_end;
+	unbroken = (unbroken && other.unbroken && joined);
+}
+
+ReportEngine::ReportEngine(const Settings &settings, const SegmentArchive &segment_archive, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		segment_archive_(segment_archive),
+		restart_pending_(false)
+{
+	QObject::connect(&watcher_, &QFutureWatcherBase::progressRangeChanged, this, &ReportEngine::progressRangeChanged);
+	QObject::connect(&watcher_, &QFutureWatcherBase::progressValueChanged, this, &ReportEngine::progressValueChanged);
+	QObject::connect(&watcher_, &QFutureWatcherBase::finished, this, &ReportEngine::finishReport);
+}
+
+ReportEngine::~ReportEngine()
+{
+	watcher_.cancel();
+	watcher_.waitForFinished();
+}
+
+bool ReportEngine::isRunning() const
+{
+	return watcher_.isRunning();
+}
+
+void ReportEngine::start(const QDate &first, const QDate &last)
+{
+	// A running report is canceled, and the new one started from finishReport once the workers
+	// have returned, so the GUI thread never waits for them
+	if (watcher_.isRunning()) {
+		pending_first_ = first;
+		pending_last_ = last;
+		restart_pending_ = true;
+		watcher_.cancel();
+		return;
+	}
+
+	first_ = first;
+	last_ = last;
+	const int day_start_hour = settings_.getDayStartHour();
+	const qint64 from = getWorkDayStartMSec(first, day_start_hour);
+	const qint64 to = getWorkDayStartMSec(last.addDays(1), day_start_hour);
+
+	// Blocks are time-ordered, so selecting the blocks in range partitions the range itself. The blocks
+	// are copied here, archived blocks are never rewritten, so the workers read immutable data
+	std::vector<ReportChunk> chunks;
+	for (const SegmentBlock &block : segment_archive_.getBlocks())
+		if ((block.max_start >= from) && (block.min_start < to))
+			chunks.push_back(ReportChunk{segment_archive_.getFileName(), block, from, to, day_start_hour});
+
+	if (settings_.logToFile())
+		Logger::Log("[REPORT] Building Report for " + first.toString(Qt::ISODate) + " - " + last.toString(Qt::ISODate) + " from " + QString::number(chunks.size()) + " Blocks");
+
+	watcher_.setFuture(QtConcurrent::mappedReduced(chunks, aggregateChunk, mergeChunk, QtConcurrent::OrderedReduce));
+}
+
+void ReportEngine::cancel()
+{
+	restart_pending_ = false;
+	if (watcher_.isRunning())
+		watcher_.cancel();
+}
+
+void ReportEngine::finishReport()
+{
+	if (restart_pending_) {
+		restart_pending_ = false;
+		start(pending_first_, pending_last_);
+		return;
+	}
+	if (watcher_.isCanceled()) {
+		if (settings_.logToFile())
+			Logger::Log("[REPORT] Report canceled");
+		emit reportCanceled();
+		return;
+	}
+	emit reportReady(buildReport(watcher_.result()));
+}
+
+Report ReportEngine::buildReport(const ReportData &data) const
+{
+	Report report;
+	report.first = first_;
+	report.last = last_;
+	report.activity = 0;
+	report.pause = data.pause;
+	report.overtime = 0;
+	report.longest_stretch = data.longest_stretch;
+	report.autopauses = data.autopauses;
+	report.days_worked = 0;
+	report.statistics = data.statistics;
+
+	const qint64 t_target = settings_.getDailyTargetMsec();
+	for (const auto &day : data.activity_per_day) {
+		report.activity += day.second;
+		report.overtime += day.second - t_target;
+		++report.days_worked;
+	}
+	report.average_activity = (report.days_worked > 0) ? (report.activity / report.days_worked) : 0;
+	return report;
+}
@@ -0,0 +1,83 @@
+#ifndef REPORTENGINE_H
+#define REPORTENGINE_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QDate>
+#include <QFutureWatcher>
+#include <map>
+#include "settings.h"
+#include "segmentarchive.h"
+
+// Aggregate over a time-ordered run of segments; the partial results of the workers are merged in
+// order, so that stretches crossing block boundaries are joined from the pieces at both ends
+struct ReportData
+{
+	std::map<qint64, qint64> activity_per_day;	// day number -> msec
+	qint64 pause;
+	qint64 longest_stretch;	// longest activity without pause
+	quint32 autopauses;
+	bool empty;
+	bool unbroken;				// all segments form one stretch
+	qint64 leading_start;	// stretch the segments start with, 0 if they start with a pause
+	qint64 leading_stretch;
+	qint64 trailing_end;		// stretch still open after the last segment
+	qint64 trailing_stretch;
+	SegmentStatistics statistics;
+
+	ReportData();
+	void merge(const ReportData &other);
+};
+
+struct Report
+{
+	QDate first;
+	QDate last;
+	qint64 activity;
+	qint64 pause;
+	qint64 average_activity;	// per day worked
+	qint64 overtime;				// against the daily target, over all days worked
+	qint64 longest_stretch;
+	quint32 autopauses;
+	int days_worked;
+	SegmentStatistics statistics;
+};
+
+// Builds reports from the segment archive on the global thread pool. Archive blocks are the work items,
+// each one is decoded and aggregated by a worker, and the partial results are merged as they come in.
+class ReportEngine : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	const SegmentArchive & segment_archive_;
+	QFutureWatcher<ReportData> watcher_;
+	QDate first_;
+	QDate last_;
+	QDate pending_first_;
+	QDate pending_last_;
+	bool restart_pending_;
+
+	Report buildReport(const ReportData &data) const;
+
+public:
+	explicit ReportEngine(const Settings & settings, const SegmentArchive & segment_archive, QObject *parent = nullptr);
+	~ReportEngine();
+	bool isRunning() const;
+
+signals:
+	void progressRangeChanged(int minimum, int maximum);
+	void progressValueChanged(int value);
+	void reportReady(const Report &report);
+	void reportCanceled();
+
+public slots:
+	void start(const QDate &first, const QDate &last);
+	void cancel();
+
+private slots:
+	void finishReport();
+};
+
+#endif // REPORTENGINE_H
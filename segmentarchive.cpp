@@ -0,0 +1,405 @@
+#include "segmentarchive.h"
+#include <QDateTime>
+#include <QByteArray>
+#include <algorithm>
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	struct ArchiveHeader
+	{
+		quint32 magic;
+		quint32 version;
+	};
+
+	struct BlockHeader
+	{
+		quint32 magic;
+		quint32 count;
+		quint32 payload_size;
+		quint32 flags;
+		qint64 min_start;
+		qint64 max_start;
+		qint64 totals[4];
+	};
+
+	static_assert(sizeof(BlockHeader) == 64, "BlockHeader is part of the file format");
+
+	const quint32 archive_magic = 0x41535455; // "UTSA"
+	const quint32 archive_version = 1;
+	const quint32 block_magic = 0x4b4c4253; // "SBLK"
+	const quint32 block_has_projects = 0x1;
+	const size_t block_capacity = 4096;
+	const qint64 archive_header_size = sizeof(ArchiveHeader);
+	const qint64 block_header_size = sizeof(BlockHeader);
+	const size_t type_count = 4;
+	const qint64 msec_per_hour = Q_INT64_C(3600000);
+	const qint64 msec_per_day = 24 * msec_per_hour;
+	const std::array<qint64, 5> pause_length_bounds = {{ 5 * 60000, 15 * 60000, 30 * 60000, 60 * 60000, 120 * 60000 }};
+
+	quint64 zigzag(const qint64 value)
+	{
+		return ((static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+	}
+
+	qint64 unzigzag(const quint64 value)
+	{
+		return (static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1));
+	}
+
+	qint64 getLocalOffset(const qint64 msecs)
+	{
+		return (QDateTime::fromMSecsSinceEpoch(msecs).offsetFromUtc() * Q_INT64_C(1000));
+	}
+
+	qint64 floorDiv(const qint64 value, const qint64 divisor)
+	{
+		return ((value >= 0) ? (value / divisor) : -((-value + divisor - 1) / divisor));
+	}
+}
+
+void SegmentColumns::clear()
+{
+	starts.clear();
+	durations.clear();
+	types.clear();
+	projects.clear();
+}
+
+size_t SegmentColumns::size() const
+{
+	return starts.size();
+}
+
+SegmentStatistics::SegmentStatistics()
+{
+	totals.fill(0);
+	activity_per_weekday.fill(0);
+	activity_per_hour.fill(0);
+	pause_count_by_length.fill(0);
+}
+
+void SegmentStatistics::add(const SegmentStatistics &other)
+{
+	for (size_t i = 0; i < totals.size(); ++i)
+		totals[i] += other.totals[i];
+	for (size_t i = 0; i < activity_per_weekday.size(); ++i)
+		activity_per_weekday[i] += other.activity_per_weekday[i];
+	for (size_t i = 0; i < activity_per_hour.size(); ++i)
+		activity_per_hour[i] += other.activity_per_hour[i];
+	for (size_t i = 0; i < pause_count_by_length.size(); ++i)
+		pause_count_by_length[i] += other.pause_count_by_length[i];
+}
+
+SegmentArchive::SegmentArchive(const Settings &settings, const QString &filename, const bool read_only, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		file_(filename),
+		read_only_(read_only)
+{
+	if (!openFile()) {
+		if (settings_.logToFile())
+			Logger::Log("[ARCHIVE] Could not open " + filename + ", Segments are not archived");
+		file_.close();
+		blocks_.clear();
+	}
+}
+
+bool SegmentArchive::openFile()
+{
+	if (!file_.open(read_only_ ? QIODevice::ReadOnly : QIODevice::ReadWrite))
+		return false;
+
+	ArchiveHeader header;
+	if ((file_.size() == 0) && !read_only_) {
+		header = ArchiveHeader{archive_magic, archive_version};
+		return (file_.write(reinterpret_cast<const char*>(&header), archive_header_size) == archive_header_size);
+	}
+	if ((file_.read(reinterpret_cast<char*>(&header), archive_header_size) != archive_header_size)
+			|| (header.magic != archive_magic) || (header.version != archive_version))
+		return false;
+
+	// Only the block headers are read, the payloads are skipped
+	qint64 offset = archive_header_size;
+	while (offset + block_header_size <= file_.size()) {
+		BlockHeader block_header;
+		if (!file_.seek(offset) || (file_.read(reinterpret_cast<char*>(&block_header), block_header_size) != block_header_size))
+			break;
+		if ((block_header.magic != block_magic) || (offset + block_header_size + block_header.payload_size > file_.size()))
+			break;
+
+		SegmentBlock block;
+		block.offset = offset;
+		block.count = block_header.count;
+		block.payload_size = block_header.payload_size;
+		block.flags = block_header.flags;
+		block.min_start = block_header.min_start;
+		block.max_start = block_header.max_start;
+		std::copy(block_header.totals, block_header.totals + type_count, block.totals.begin());
+		blocks_.push_back(block);
+		offset += block_header_size + block_header.payload_size;
+	}
+
+	// A read-only reader just stops at the last complete block, the tracking instance drops the rest
+	if ((offset != file_.size()) && !read_only_) {
+		if (settings_.logToFile())
+			Logger::Log("[ARCHIVE] Dropping " + QString::number(file_.size() - offset) + " Bytes of incomplete Data at the End");
+		file_.resize(offset);
+	}
+	return true;
+}
+
+bool SegmentArchive::isOpen() const
+{
+	return file_.isOpen();
+}
+
+QString SegmentArchive::getFileName() const
+{
+	return file_.fileName();
+}
+
+std::vector<SegmentBlock> SegmentArchive::getBlocks() const
+{
+	return blocks_;
+}
+
+bool SegmentArchive::appendBlock(const SegmentColumns &columns)
+{
+	const qint64 offset = file_.size();
+	BlockHeader header;
+	header.magic = block_magic;
+	header.count = static_cast<quint32>(columns.size());
+	header.flags = block_has_projects;
+	header.min_start = *std::min_element(columns.starts.begin(), columns.starts.end());
+	header.max_start = *std::max_element(columns.starts.begin(), columns.starts.end());
+	std::fill(header.totals, header.totals + type_count, 0);
+
+	QByteArray payload;
+	payload.reserve(static_cast<int>(columns.size() * 9));
+	qint64 previous_start = 0;
+	for (size_t i = 0; i < columns.size(); ++i) {
+		putVarint(payload, zigzag(columns.starts[i] - previous_start));
+		previous_start = columns.starts[i];
+	}
+	for (size_t i = 0; i < columns.size(); ++i) {
+		putVarint(payload, zigzag(columns.durations[i]));
+		header.totals[columns.types[i]] += columns.durations[i];
+	}
+	payload.append(reinterpret_cast<const char*>(columns.types.data()), static_cast<int>(columns.size()));
+	for (size_t i = 0; i < columns.size(); ++i)
+		putVarint(payload, columns.projects[i]);
+	header.payload_size = static_cast<quint32>(payload.size());
+
+	// A block cut short by a crash fails the size check on the next open and is dropped there
+	if (!file_.seek(offset)
+			|| (file_.write(reinterpret_cast<const char*>(&header), block_header_size) != block_header_size)
+			|| (file_.write(payload) != payload.size())
+			|| !file_.flush()) {
+		if (settings_.logToFile())
+			Logger::Log("[ARCHIVE] Could not write Block");
+		file_.resize(offset);
+		return false;
+	}
+
+	SegmentBlock block;
+	block.offset = offset;
+	block.count = header.count;
+	block.payload_size = header.payload_size;
+	block.flags = header.flags;
+	block.min_start = header.min_start;
+	block.max_start = header.max_start;
+	std::copy(header.totals, header.totals + type_count, block.totals.begin());
+	blocks_.push_back(block);
+	return true;
+}
+
+bool SegmentArchive::readBlock(QFile &file, const SegmentBlock &block, SegmentColumns &columns)
+{
+	columns.clear();
+	if (!file.seek(block.offset + block_header_size))
+		return false;
+	const QByteArray payload = file.read(block.payload_size);
+	if (payload.size() != static_cast<int>(block.payload_size))
+		return false;
+
+	const uchar *pos = reinterpret_cast<const uchar*>(payload.constData());
+	const uchar * const end = pos + payload.size();
+	columns.starts.resize(block.count);
+	columns.durations.resize(block.count);
+	columns.types.resize(block.count);
+	columns.projects.assign(block.count, 0);
+
+	quint64 value = 0;
+	qint64 previous_start = 0;
+	for (size_t i = 0; i < block.count; ++i) {
+		if (!getVarint(pos, end, value))
+			return false;
+		previous_start += unzigzag(value);
+		columns.starts[i] = previous_start;
+	}
+	for (size_t i = 0; i < block.count; ++i) {
+		if (!getVarint(pos, end, value))
+			return false;
+		columns.durations[i] = unzigzag(value);
+	}
+	if (static_cast<size_t>(end - pos) < block.count)
+		return false;
+	std::copy(pos, pos + block.count, columns.types.begin());
+	pos += block.count;
+
+	if (block.flags & block_has_projects) {
+		for (size_t i = 0; i < block.count; ++i) {
+			if (!getVarint(pos, end, value))
+				return false;
+			columns.projects[i] = static_cast<quint16>(value);
+		}
+	}
+	return true;
+}
+
+void SegmentArchive::addTotals(const SegmentColumns &columns, const qint64 from, const qint64 to, std::array<qint64, 4> &totals)
+{
+	// Branch-free selection and one pass per type over contiguous columns, so that the compiler
+	// turns each inner loop into SIMD code
+	const size_t count = columns.size();
+	const qint64 * const starts = columns.starts.data();
+	const qint64 * const durations = columns.durations.data();
+	const quint8 * const types = columns.types.data();
+
+	for (size_t type = 0; type < type_count; ++type) {
+		qint64 sum = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const qint64 selected = -static_cast<qint64>((starts[i] >= from) & (starts[i] < to) & (types[i] == type));
+			sum += (durations[i] & selected);
+		}
+		totals[type] += sum;
+	}
+}
+
+void SegmentArchive::addStatistics(const SegmentColumns &columns, const qint64 from, const qint64 to, SegmentStatistics &statistics)
+{
+	if (columns.size() == 0)
+		return;
+
+	addTotals(columns, from, to, statistics.totals);
+
+	// The local time offset is looked up once per block, unless a DST switch falls into it
+	const qint64 first_offset = getLocalOffset(columns.starts.front());
+	const bool constant_offset = (first_offset == getLocalOffset(columns.starts.back()));
+
+	for (size_t i = 0; i < columns.size(); ++i) {
+		const qint64 start = columns.starts[i];
+		const qint64 duration = columns.durations[i];
+		if ((start < from) || (start >= to))
+			continue;
+
+		const SegmentType type = static_cast<SegmentType>(columns.types[i]);
+		if (type == SegmentType::Activity) {
+			qint64 local_time = start + (constant_offset ? first_offset : getLocalOffset(start));
+			const qint64 day = floorDiv(local_time, msec_per_day);
+			statistics.activity_per_weekday[static_cast<size_t>(((day + 3) % 7 + 7) % 7)] += duration; // 1970-01-01 was a Thursday
+
+			qint64 remaining = duration;
+			while (remaining > 0) {
+				const qint64 time_of_day = local_time - floorDiv(local_time, msec_per_day) * msec_per_day;
+				const qint64 chunk = qMin(remaining, msec_per_hour - (time_of_day % msec_per_hour));
+				statistics.activity_per_hour[static_cast<size_t>(time_of_day / msec_per_hour)] += chunk;
+				local_time += chunk;
+				remaining -= chunk;
+			}
+		}
+		else if ((type == SegmentType::Pause) || (type == SegmentType::Autopause)) {
+			size_t bucket = 0;
+			while ((bucket < pause_length_bounds.size()) && (duration >= pause_length_bounds[bucket]))
+				++bucket;
+			++statistics.pause_count_by_length[bucket];
+		}
+	}
+}
+
+std::array<qint64, 4> SegmentArchive::getTotals(const qint64 from, const qint64 to) const
+{
+	std::array<qint64, 4> totals;
+	totals.fill(0);
+
+	QFile file(file_.fileName());
+	SegmentColumns columns;
+	for (const SegmentBlock &block : blocks_) {
+		if ((block.max_start < from) || (block.min_start >= to))
+			continue;
+		if ((block.min_start >= from) && (block.max_start < to)) {
+			for (size_t type = 0; type < type_count; ++type)
+				totals[type] += block.totals[type];
+			continue;
+		}
+		if (!file.isOpen() && !file.open(QIODevice::ReadOnly))
+			break;
+		if (readBlock(file, block, columns))
+			addTotals(columns, from, to, totals);
+	}
+	return totals;
+}
+
+SegmentStatistics SegmentArchive::getStatistics(const qint64 from, const qint64 to) const
+{
+	SegmentStatistics statistics;
+
+	QFile file(file_.fileName());
+	SegmentColumns columns;
+	for (const SegmentBlock &block : blocks_) {
+		if ((block.max_start < from) || (block.min_start >= to))
+			continue;
+		if (!file.isOpen() && !file.open(QIODevice::ReadOnly))
+			break;
+		if (readBlock(file, block, columns))
+			addStatistics(columns, from, to, statistics);
+	}
+	return statistics;
+}
+
+std::vector<TimeSegment> SegmentArchive::getSegments(const qint64 from, const qint64 to) const
+{
+	std::vector<TimeSegment> segments;
+
+	QFile file(file_.fileName());
+	SegmentColumns columns;
+	for (const SegmentBlock &block : blocks_) {
+		if ((block.max_start < from) || (block.min_start >= to))
+			continue;
+		if (!file.isOpen() && !file.open(QIODevice::ReadOnly))
+			break;
+		if (!readBlock(file, block, columns))
+			continue;
+		for (size_t i = 0; i < columns.size(); ++i)
+			if ((columns.starts[i] >= from) && (columns.starts[i] < to))
+				segments.push_back(TimeSegment{static_cast<SegmentType>(columns.types[i]), columns.starts[i], columns.durations[i], columns.projects[i]});
+	}
+	return segments;
+}
+
+void SegmentArchive::addSession(const std::vector<TimeSegment> &segments)
+{
+	if (!isOpen() || read_only_)
+		return;
+
+	// Each session starts its own blocks behind the existing ones instead of filling up the last block,
+	// which would mean rewriting archived segments in place
+	SegmentColumns columns;
+	for (const TimeSegment &segment : segments) {
+		if (segment.duration <= 0)
+			continue;
+		if (columns.size() == block_capacity) {
+			if (!appendBlock(columns))
+				return;
+			columns.clear();
+		}
+		columns.starts.push_back(segment.start);
+		columns.durations.push_back(segment.duration);
+		columns.types.push_back(static_cast<quint8>(segment.type));
+		columns.projects.push_back(segment.project);
+	}
+
+	if (columns.size() > 0)
+		appendBlock(columns);
+}
@@ -0,0 +1,86 @@
+#ifndef SEGMENTARCHIVE_H
+#define SEGMENTARCHIVE_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QFile>
+#include <QString>
+#include <array>
+#include <vector>
+#include "settings.h"
+#include "types.h"
+
+// Summary of one archive block, kept in memory for all blocks so whole blocks can be skipped or
+// answered without decoding them
+struct SegmentBlock
+{
+	qint64 offset;			// of the block header in the file
+	quint32 count;
+	quint32 payload_size;
+	quint32 flags;
+	qint64 min_start;
+	qint64 max_start;
+	std::array<qint64, 4> totals;	// duration per SegmentType
+};
+
+// One decoded block, column by column
+struct SegmentColumns
+{
+	std::vector<qint64> starts;
+	std::vector<qint64> durations;
+	std::vector<quint8> types;
+	std::vector<quint16> projects;
+
+	void clear();
+	size_t size() const;
+};
+
+struct SegmentStatistics
+{
+	std::array<qint64, 4> totals;							// duration per SegmentType
+	std::array<qint64, 7> activity_per_weekday;		// Monday first
+	std::array<qint64, 24> activity_per_hour;		// local time
+	std::array<qint64, 6> pause_count_by_length;	// < 5, 15, 30, 60, 120 min and longer
+
+	SegmentStatistics();
+	void add(const SegmentStatistics &other);
+};
+
+// Every segment ever tracked, appended session by session. Written blocks are never touched again,
+// so a crash while writing can only lose the session being archived. Segments are stored column-wise in blocks:
+// start times as delta, durations as plain values, both zigzag/varint-encoded, then one byte per type
+// and, in blocks written since projects exist, the project ids as varints.
+// Each block header carries min/max start and the totals per type.
+// Opened read-only, the file is neither created nor repaired, and sessions are not added.
+class SegmentArchive : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QFile file_;
+	const bool read_only_;
+	std::vector<SegmentBlock> blocks_;
+
+	bool openFile();
+	bool appendBlock(const SegmentColumns &columns);
+
+public:
+	explicit SegmentArchive(const Settings & settings, const QString &filename, const bool read_only = false, QObject *parent = nullptr);
+	bool isOpen() const;
+	QString getFileName() const;
+	std::vector<SegmentBlock> getBlocks() const;
+
+	std::array<qint64, 4> getTotals(const qint64 from, const qint64 to) const;
+	SegmentStatistics getStatistics(const qint64 from, const qint64 to) const;
+	std::vector<TimeSegment> getSegments(const qint64 from, const qint64 to) const;
+
+	static bool readBlock(QFile &file, const SegmentBlock &block, SegmentColumns &columns);
+	static void addTotals(const SegmentColumns &columns, const qint64 from, const qint64 to, std::array<qint64, 4> &totals);
+	static void addStatistics(const SegmentColumns &columns, const qint64 from, const qint64 to, SegmentStatistics &statistics);
+
+public slots:
+	void addSession(const std::vector<TimeSegment> &segments);
+};
+
+#endif // SEGMENTARCHIVE_H
@@ -0,0 +1,52 @@
+#include "segmenteditdialog.h"
+#include <QFormLayout>
+#include <QDialogButtonBox>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include "helpers.h"
+
+SegmentEditDialog::SegmentEditDialog(const Settings &settings, QWidget *parent) : QDialog(parent), settings_(settings)
+{
+	setWindowTitle("µTimer Correct Time");
+
+	const QTime now = QTime::currentTime();
+	from_edit_ = new QTimeEdit(now.addSecs(-30 * 60));
+	from_edit_->setDisplayFormat("hh:mm");
+	to_edit_ = new QTimeEdit(now);
+	to_edit_->setDisplayFormat("hh:mm");
+	type_combo_ = new QComboBox();
+	type_combo_->addItem("Activity");
+	type_combo_->addItem("Pause");
+	type_combo_->addItem("Not tracked");
+	type_combo_->setCurrentIndex(1);
+
+	QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+	QObject::connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+	QObject::connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+	QFormLayout *rows = new QFormLayout(this);
+	rows->addRow("From:", from_edit_);
+	rows->addRow("To:", to_edit_);
+	rows->addRow("was:", type_combo_);
+	rows->addRow(buttons);
+}
+
+qint64 SegmentEditDialog::getFrom() const
+{
+	return convWorkTimeToMSec(getWorkToday(settings_.getDayStartHour()), from_edit_->time(), settings_.getDayStartHour());
+}
+
+qint64 SegmentEditDialog::getTo() const
+{
+	return convWorkTimeToMSec(getWorkToday(settings_.getDayStartHour()), to_edit_->time(), settings_.getDayStartHour());
+}
+
+SegmentEdit SegmentEditDialog::getEdit() const
+{
+	switch (type_combo_->currentIndex()) {
+		case 0: return SegmentEdit::Activity;
+		case 1: return SegmentEdit::Pause;
+	}
+	return SegmentEdit::Delete;
+}
@@ -0,0 +1,28 @@
+#ifndef SEGMENTEDITDIALOG_H
+#define SEGMENTEDITDIALOG_H
+
+#include <QDialog>
+#include <QTimeEdit>
+#include <QComboBox>
+#include "settings.h"
+#include "types.h"
+
+// Asks for a range of today and what it should have been, e.g. "12:05 - 12:50 was a Pause"
+class SegmentEditDialog : public QDialog
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QTimeEdit *from_edit_;
+	QTimeEdit *to_edit_;
+	QComboBox *type_combo_;
+
+public:
+	explicit SegmentEditDialog(const Settings & settings, QWidget *parent = nullptr);
+	qint64 getFrom() const;
+	qint64 getTo() const;
+	SegmentEdit getEdit() const;
+};
+
+#endif // SEGMENTEDITDIALOG_H
@@ -2,12 +2,16 @@
 #include "helpers.h"
 #include "logger.h"
 
-Settings::Settings(const QString filename) : sfile_(filename, QSettings::IniFormat)
+Settings::Settings(const QString filename, const bool read_only) : sfile_(filename, QSettings::IniFormat), read_only_(read_only)
 {
 	sfile_.setIniCodec("UTF-8");
 	readSettingsFile();
-	sfile_.clear();
+	if (read_only_) {
+		log_to_file_ = false;
+		return;
+	}
 	writeSettingsFile();
+	removeUnknownKeys();
 	sfile_.sync();
 }
 
@@ -15,6 +19,7 @@ void Settings::readSettingsFile()
 {
 	autostart_timing_ = sfile_.value("uTimer/press_start_button_on_app_start", true).toBool();
 	autopause_enabled_ = sfile_.value("uTimer/autopause_enabled", true).toBool();
+	autopause_on_idle_ = sfile_.value("uTimer/autopause_on_input_idle", false).toBool();
 	backpause_min_ = qBound(0, sfile_.value("uTimer/autopause_threshold_minutes", 15).toInt(), 99);
 	start_minimized_ = sfile_.value("uTimer/start_minimized_to_tray", false).toBool();
 	start_pinned_to_top_ = sfile_.value("uTimer/start_pinned_to_top", false).toBool();
@@ -23,22 +28,63 @@ void Settings::readSettingsFile()
 	pause_for_warning_nopause_min_ = 30;
 	warning_activity_ = sfile_.value("uTimer/show_warning_after_9h45min_activity", false).toBool();
 	warning_activity_min_ = 9*60+45;
+	daily_target_min_ = qBound(0, sfile_.value("uTimer/daily_target_minutes", 8*60).toInt(), 24*60);
 	log_to_file_ = sfile_.value("uTimer/debug_log_to_file", true).toBool();
+	sleep_as_pause_ = sfile_.value("uTimer/count_system_sleep_as_pause", true).toBool();
+	control_socket_ = sfile_.value("uTimer/enable_control_socket", true).toBool();
+	metrics_port_ = qBound(0, sfile_.value("uTimer/metrics_port_or_0_to_disable", 0).toInt(), 65535);
+	track_foreground_apps_ = sfile_.value("uTimer/track_foreground_applications", false).toBool();
+	shared_history_folder_ = sfile_.value("uTimer/shared_history_folder_or_empty", "").toString().trimmed();
+	hook_commands_.clear();
+	for (int i = 0; i < transition_count; ++i)
+		hook_commands_.append(sfile_.value("uTimer/run_on_" + getTransitionName(static_cast<Transition>(i)) + "_or_empty", "").toString().trimmed());
+	hook_timeout_sec_ = qBound(1, sfile_.value("uTimer/hook_timeout_seconds", 10).toInt(), 600);
+	day_start_hour_ = qBound(0, sfile_.value("uTimer/day_starts_at_hour", 4).toInt(), 23);
+	restart_at_day_start_ = sfile_.value("uTimer/restart_timer_at_day_start", true).toBool();
+	theme_ = (sfile_.value("uTimer/theme_light_or_dark", "light").toString() == "dark") ? "dark" : "light";
 }
 
 void Settings::writeSettingsFile()
 {
-	sfile_.setValue("uTimer/press_start_button_on_app_start", autostart_timing_);
-	sfile_.setValue("uTimer/autopause_enabled", autopause_enabled_);
-	sfile_.setValue("uTimer/autopause_threshold_minutes", backpause_min_);
-	sfile_.setValue("uTimer/start_minimized_to_tray", start_minimized_);
-	sfile_.setValue("uTimer/start_pinned_to_top", start_pinned_to_top_);
-	sfile_.setValue("uTimer/show_warning_when_not_30min_pause_after_6h_activity", warning_nopause_);
-	sfile_.setValue("uTimer/show_warning_after_9h45min_activity", warning_activity_);
-	sfile_.setValue("uTimer/debug_log_to_file", log_to_file_);
+	updateValue("uTimer/press_start_button_on_app_start", autostart_timing_);
+	updateValue("uTimer/autopause_enabled", autopause_enabled_);
+	updateValue("uTimer/autopause_on_input_idle", autopause_on_idle_);
+	updateValue("uTimer/autopause_threshold_minutes", backpause_min_);
+	updateValue("uTimer/start_minimized_to_tray", start_minimized_);
+	updateValue("uTimer/start_pinned_to_top", start_pinned_to_top_);
+	updateValue("uTimer/show_warning_when_not_30min_pause_after_6h_activity", warning_nopause_);
+	updateValue("uTimer/show_warning_after_9h45min_activity", warning_activity_);
+	updateValue("uTimer/daily_target_minutes", daily_target_min_);
+	updateValue("uTimer/debug_log_to_file", log_to_file_);
+	updateValue("uTimer/count_system_sleep_as_pause", sleep_as_pause_);
+	updateValue("uTimer/enable_control_socket", control_socket_);
+	updateValue("uTimer/metrics_port_or_0_to_disable", metrics_port_);
+	updateValue("uTimer/track_foreground_applications", track_foreground_apps_);
+	updateValue("uTimer/shared_history_folder_or_empty", shared_history_folder_);
+	for (int i = 0; i < transition_count; ++i)
+		updateValue("uTimer/run_on_" + getTransitionName(static_cast<Transition>(i)) + "_or_empty", hook_commands_[i]);
+	updateValue("uTimer/hook_timeout_seconds", hook_timeout_sec_);
+	updateValue("uTimer/day_starts_at_hour", day_start_hour_);
+	updateValue("uTimer/restart_timer_at_day_start", restart_at_day_start_);
+	updateValue("uTimer/theme_light_or_dark", theme_);
 
 	if (log_to_file_)
-		Logger::Log("Current Autopause Settings are: Enabled = " + QString::number(autopause_enabled_) + "; Minutes = " + QString::number(backpause_min_));
+		Logger::Log("Current Autopause Settings are: Enabled = " + QString::number(autopause_enabled_) + "; Minutes = " + QString::number(backpause_min_) + "; On Input Idle = " + QString::number(autopause_on_idle_));
+}
+
+void Settings::updateValue(const QString &key, const QVariant &value)
+{
+	// Unchanged values are left alone, so an up-to-date settings file is not rewritten on every start
+	if (!sfile_.contains(key) || (sfile_.value(key).toString() != value.toString()))
+		sfile_.setValue(key, value);
+	known_keys_.insert(key);
+}
+
+void Settings::removeUnknownKeys()
+{
+	for (const QString &key : sfile_.allKeys())
+		if (!known_keys_.contains(key))
+			sfile_.remove(key);
 }
 
 bool Settings::isAutopauseEnabled() const
@@ -46,6 +92,11 @@ bool Settings::isAutopauseEnabled() const
 	return autopause_enabled_;
 }
 
+bool Settings::isInputIdleAutopauseEnabled() const
+{
+	return autopause_on_idle_;
+}
+
 bool Settings::isAutostartTimingEnabled() const
 {
 	return autostart_timing_;
@@ -76,6 +127,56 @@ bool Settings::logToFile() const
 	return log_to_file_;
 }
 
+bool Settings::isSleepCountedAsPause() const
+{
+	return sleep_as_pause_;
+}
+
+bool Settings::isControlSocketEnabled() const
+{
+	return control_socket_;
+}
+
+bool Settings::isForegroundTrackingEnabled() const
+{
+	return track_foreground_apps_;
+}
+
+bool Settings::isRestartAtDayStartEnabled() const
+{
+	return restart_at_day_start_;
+}
+
+int Settings::getDayStartHour() const
+{
+	return day_start_hour_;
+}
+
+quint16 Settings::getMetricsPort() const
+{
+	return static_cast<quint16>(metrics_port_);
+}
+
+QString Settings::getThemeName() const
+{
+	return theme_;
+}
+
+QString Settings::getSharedHistoryFolder() const
+{
+	return shared_history_folder_;
+}
+
+QString Settings::getHookCommand(const Transition transition) const
+{
+	return hook_commands_.value(static_cast<int>(transition));
+}
+
+int Settings::getHookTimeoutMsec() const
+{
+	return hook_timeout_sec_ * 1000;
+}
+
 QString Settings::getBackpauseMin() const
 {
 	return QString::number(backpause_min_);
@@ -101,8 +202,16 @@ qint64 Settings::getWarnTimeActivityMsec() const
 	return convMinToMsec(warning_activity_min_);
 }
 
+qint64 Settings::getDailyTargetMsec() const
+{
+	// Without a target the icon shows the progress toward the activity warning instead
+	return convMinToMsec((daily_target_min_ > 0) ? daily_target_min_ : warning_activity_min_);
+}
+
 void Settings::setAutopauseState(const bool autopause_enabled)
 {
+	if (read_only_)
+		return;
 	sfile_.sync();
 	readSettingsFile();
 	autopause_enabled_ = autopause_enabled;
@@ -111,6 +220,8 @@ void Settings::setAutopauseState(const bool autopause_enabled)
 
 void Settings::setPinToTopState(const bool pin2top_enabled)
 {
+	if (read_only_)
+		return;
 	sfile_.sync();
 	start_pinned_to_top_ = pin2top_enabled;
 	writeSettingsFile();
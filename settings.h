@@ -4,13 +4,20 @@
 #include <QtGlobal>
 #include <QSettings>
 #include <QString>
+#include <QVariant>
+#include <QSet>
+#include <QStringList>
+#include "types.h"
 
 class Settings
 {
 private:
 	QSettings sfile_;
+	QSet<QString> known_keys_;
+	bool read_only_;
 	int backpause_min_;
 	bool autopause_enabled_;
+	bool autopause_on_idle_;
 	bool autostart_timing_;
 	bool start_minimized_;
 	bool start_pinned_to_top_;
@@ -19,24 +26,50 @@ private:
 	int warning_nopause_min_;
 	int pause_for_warning_nopause_min_;
 	int warning_activity_min_;
+	int daily_target_min_;
 	bool log_to_file_;
+	bool sleep_as_pause_;
+	bool control_socket_;
+	int metrics_port_;
+	bool track_foreground_apps_;
+	QString shared_history_folder_;
+	QStringList hook_commands_;	// by Transition
+	int hook_timeout_sec_;
+	int day_start_hour_;
+	bool restart_at_day_start_;
+	QString theme_;
 	void readSettingsFile();
 	void writeSettingsFile();
+	void updateValue(const QString &key, const QVariant &value);
+	void removeUnknownKeys();
 
 public:
-	Settings(const QString filename);
+	// A read-only instance never writes the settings file and never logs, for runs beside the tracking instance
+	Settings(const QString filename, const bool read_only = false);
 	bool isAutopauseEnabled() const;
+	bool isInputIdleAutopauseEnabled() const;
 	bool isAutostartTimingEnabled() const;
 	bool isMinimizedStartEnabled() const;
 	bool isPinnedStartEnabled() const;
 	bool showNoPauseWarning() const;
 	bool showTooMuchActivityWarning() const;
 	bool logToFile() const;
+	bool isSleepCountedAsPause() const;
+	bool isControlSocketEnabled() const;
+	bool isForegroundTrackingEnabled() const;
+	bool isRestartAtDayStartEnabled() const;
+	int getDayStartHour() const;
+	quint16 getMetricsPort() const;
+	QString getThemeName() const;
+	QString getSharedHistoryFolder() const;
+	QString getHookCommand(const Transition transition) const;
+	int getHookTimeoutMsec() const;
 	QString getBackpauseMin() const;
 	qint64 getBackpauseMsec() const;
 	qint64 getPauseTimeForWarnTimeNoPauseMsec() const;
 	qint64 getWarnTimeNoPauseMsec() const;
 	qint64 getWarnTimeActivityMsec() const;
+	qint64 getDailyTargetMsec() const;
 	void setAutopauseState(const bool autopause_enabled);
 	void setPinToTopState(const bool pin2top_enabled);
 };
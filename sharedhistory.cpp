@@ -0,0 +1,351 @@
+#include "sharedhistory.h"
+#include <QFileInfo>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QHostInfo>
+#include <QRegularExpression>
+#include <algorithm>
+#include "historystore.h"
+#include "helpers.h"
+#include "logger.h"
+
+namespace {
+	struct SharedFileHeader
+	{
+		quint32 magic;
+		quint32 version;
+	};
+
+	struct SharedRecord
+	{
+		quint64 seq;
+		qint64 start;
+		qint64 duration;
+		quint32 type;
+		quint32 reserved;
+	};
+
+	static_assert(sizeof(SharedRecord) == 32, "SharedRecord is part of the file format");
+
+	const quint32 shared_magic = 0x48535455; // "UTSH"
+	const quint32 shared_version = 1;
+	const qint64 header_size = sizeof(SharedFileHeader);
+	const qint64 record_size = sizeof(SharedRecord);
+	const QString file_suffix = "segments";
+	const int rescan_interval_msec = 60 * 1000; // change notifications don't work on every network share
+	const qint64 kept_days = 62;
+	const quint32 state_magic = 0x53535455; // "UTSS"
+	const quint32 state_version = 1;
+}
+
+SharedHistory::SharedHistory(const Settings &settings, const QString &state_filename, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		state_filename_(state_filename),
+		next_seq_(0)
+{
+	if (settings_.getSharedHistoryFolder().isEmpty())
+		return;
+
+	folder_.setPath(settings_.getSharedHistoryFolder());
+	machine_ = QHostInfo::localHostName().replace(QRegularExpression("[^A-Za-z0-9_-]"), "_");
+	if (machine_.isEmpty())
+		machine_ = "unknown";
+	own_file_.setFileName(folder_.filePath(machine_ + "." + file_suffix));
+
+	if (!folder_.exists() || !openOwnFile()) {
+		if (settings_.logToFile())
+			Logger::Log("[SHARED] Could not open " + own_file_.fileName() + ", History is not shared");
+		own_file_.close();
+		return;
+	}
+
+	QObject::connect(&watcher_, &QFileSystemWatcher::directoryChanged, this, &SharedHistory::mergeAll);
+	QObject::connect(&watcher_, &QFileSystemWatcher::fileChanged, this, &SharedHistory::mergeChangedFile);
+	QObject::connect(&rescan_timer_, &QTimer::timeout, this, &SharedHistory::mergeAll);
+	watcher_.addPath(folder_.absolutePath());
+	rescan_timer_.start(rescan_interval_msec);
+
+	// Reading the shared folder, possibly on a network share, must not hold up the start
+	const bool state_loaded = loadState();
+	QTimer::singleShot(0, this, &SharedHistory::mergeOnStart);
+	if (settings_.logToFile())
+		Logger::Log("[SHARED] Sharing History as '" + machine_ + "'" + (state_loaded ? ", merged " + QString::number(machines_.size()) + " Machines before" : QString()));
+}
+
+void SharedHistory::mergeOnStart()
+{
+	mergeAll();
+	emitToday(); // the state of the last run may not have changed, but it is news for whoever connected
+}
+
+bool SharedHistory::loadState()
+{
+	QFile file(state_filename_);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_0);
+	quint32 magic = 0;
+	quint32 version = 0;
+	QString folder;
+	in >> magic >> version >> folder;
+	if ((magic != state_magic) || (version != state_version) || (folder != folder_.absolutePath()))
+		return false;
+
+	QStringList machines;
+	std::vector<quint64> counts;
+	QHash<QString, qint64> offsets;
+	std::map<qint64, std::vector<Interval>> activity_per_day;
+	quint32 machine_count = 0;
+	in >> machine_count;
+	for (quint32 i = 0; (i < machine_count) && (in.status() == QDataStream::Ok); ++i) {
+		QString machine;
+		quint64 count = 0;
+		in >> machine >> count;
+		machines << machine;
+		counts.push_back(count);
+	}
+	in >> offsets;
+	quint32 day_count = 0;
+	in >> day_count;
+	for (quint32 i = 0; (i < day_count) && (in.status() == QDataStream::Ok); ++i) {
+		qint64 day = 0;
+		quint32 interval_count = 0;
+		in >> day >> interval_count;
+		std::vector<Interval> &intervals = activity_per_day[day];
+		for (quint32 j = 0; (j < interval_count) && (in.status() == QDataStream::Ok); ++j) {
+			Interval interval;
+			in >> interval.first >> interval.second;
+			intervals.push_back(interval);
+		}
+	}
+	if (in.status() != QDataStream::Ok)
+		return false;
+
+	// Ids are handed out in order, so interning the names in stored order gives the stored ids
+	quint16 id = 0;
+	for (const QString &machine : machines)
+		if (!machines_.intern(machine, id))
+			return false;
+	merged_counts_ = counts;
+	offsets_ = offsets;
+	activity_per_day_ = activity_per_day;
+	return true;
+}
+
+void SharedHistory::saveState() const
+{
+	// Written to a temporary file and renamed, so a crash leaves the previous state
+	QSaveFile file(state_filename_);
+	if (!file.open(QIODevice::WriteOnly)) {
+		if (settings_.logToFile())
+			Logger::Log("[SHARED] Could not write " + state_filename_);
+		return;
+	}
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << state_magic << state_version << folder_.absolutePath();
+	out << static_cast<quint32>(merged_counts_.size());
+	for (size_t id = 0; id < merged_counts_.size(); ++id)
+		out << machines_.getString(static_cast<quint16>(id)) << merged_counts_[id];
+	out << offsets_;
+	out << static_cast<quint32>(activity_per_day_.size());
+	for (const auto &day : activity_per_day_) {
+		out << day.first << static_cast<quint32>(day.second.size());
+		for (const Interval &interval : day.second)
+			out << interval.first << interval.second;
+	}
+	if (!file.commit() && settings_.logToFile())
+		Logger::Log("[SHARED] Could not write " + state_filename_);
+}
+
+bool SharedHistory::isEnabled() const
+{
+	return own_file_.isOpen();
+}
+
+bool SharedHistory::openOwnFile()
+{
+	if (!own_file_.open(QIODevice::ReadWrite))
+		return false;
+
+	SharedFileHeader header;
+	if (own_file_.size() < header_size) {
+		header = SharedFileHeader{shared_magic, shared_version};
+		if (!own_file_.resize(0) || (own_file_.write(reinterpret_cast<const char*>(&header), header_size) != header_size))
+			return false;
+	}
+	else if ((own_file_.read(reinterpret_cast<char*>(&header), header_size) != header_size)
+					 || (header.magic != shared_magic) || (header.version != shared_version)) {
+		return false;
+	}
+
+	// A record cut off by a crash is dropped, its sequence number is used again
+	const qint64 record_count = (own_file_.size() - header_size) / record_size;
+	if (!own_file_.resize(header_size + record_count * record_size))
+		return false;
+	next_seq_ = static_cast<quint64>(record_count);
+	return own_file_.seek(own_file_.size());
+}
+
+void SharedHistory::addSession(const std::vector<TimeSegment> &segments)
+{
+	if (!isEnabled())
+		return;
+
+	QByteArray records;
+	for (const TimeSegment &segment : segments) {
+		const SharedRecord record{next_seq_++, segment.start, segment.duration, static_cast<quint32>(segment.type), 0};
+		records.append(reinterpret_cast<const char*>(&record), record_size);
+	}
+	if ((own_file_.write(records) != records.size()) || !own_file_.flush()) {
+		if (settings_.logToFile())
+			Logger::Log("[SHARED] Could not write to " + own_file_.fileName());
+		return;
+	}
+
+	// The own file is merged like any other, so the day view is built the same way on every machine
+	if (mergeFile(own_file_.fileName())) {
+		saveState();
+		emitToday();
+	}
+}
+
+void SharedHistory::mergeAll()
+{
+	if (!isEnabled())
+		return;
+
+	bool changed = false;
+	const QFileInfoList files = folder_.entryInfoList(QStringList("*." + file_suffix), QDir::Files);
+	for (const QFileInfo &file : files) {
+		if (!watcher_.files().contains(file.absoluteFilePath()))
+			watcher_.addPath(file.absoluteFilePath());
+		changed |= mergeFile(file.absoluteFilePath());
+	}
+	if (changed) {
+		saveState();
+		emitToday();
+	}
+}
+
+void SharedHistory::mergeChangedFile(const QString &path)
+{
+	if (mergeFile(path)) {
+		saveState();
+		emitToday();
+	}
+}
+
+bool SharedHistory::mergeFile(const QString &path)
+{
+	const QString machine = QFileInfo(path).completeBaseName();
+	quint16 machine_id = 0;
+	if (!machines_.intern(machine, machine_id))
+		return false;
+
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	if (machine_id >= merged_counts_.size())
+		merged_counts_.resize(machine_id + 1, 0);
+
+	// Files are only appended to; a shorter file was recreated, e.g. after its machine lost it, and
+	// numbers its records from 0 again. It is merged again from the start, which is harmless since a
+	// day's union doesn't change by adding the same interval twice.
+	qint64 offset = offsets_.value(path, 0);
+	if (file.size() < offset) {
+		offset = 0;
+		merged_counts_[machine_id] = 0;
+	}
+	if (offset == 0) {
+		SharedFileHeader header;
+		if ((file.read(reinterpret_cast<char*>(&header), header_size) != header_size) || (header.magic != shared_magic) || (header.version != shared_version))
+			return false;
+		offset = header_size;
+	}
+
+	const qint64 record_count = (file.size() - offset) / record_size;
+	if ((record_count <= 0) || !file.seek(offset))
+		return false;
+	const QByteArray data = file.read(record_count * record_size);
+	if (data.size() != record_count * record_size)
+		return false;
+
+	const qint64 first_kept_day = getWorkToday(settings_.getDayStartHour()).toJulianDay() - kept_days;
+	activity_per_day_.erase(activity_per_day_.begin(), activity_per_day_.upper_bound(first_kept_day));
+
+	bool changed = false;
+	const SharedRecord *records = reinterpret_cast<const SharedRecord*>(data.constData());
+	for (qint64 i = 0; i < record_count; ++i) {
+		const SharedRecord &record = records[i];
+		if (record.seq != merged_counts_[machine_id])
+			continue;
+		++merged_counts_[machine_id];
+		const qint64 day = HistoryStore::getDayNumber(record.start, settings_.getDayStartHour());
+		if ((static_cast<SegmentType>(record.type) == SegmentType::Activity) && (record.duration > 0) && (day > first_kept_day)) {
+			addActivity(activity_per_day_[day], Interval(record.start, record.start + record.duration));
+			changed = true;
+		}
+	}
+	offsets_[path] = offset + record_count * record_size;
+	return changed;
+}
+
+void SharedHistory::addActivity(std::vector<Interval> &intervals, const Interval &interval)
+{
+	// Activity on two machines at the same time counts once, so a day keeps the union of all intervals
+	auto first = std::lower_bound(intervals.begin(), intervals.end(), interval, [](const Interval &a, const Interval &b) { return a.second < b.first; });
+	auto last = first;
+	Interval merged = interval;
+	while ((last != intervals.end()) && (last->first <= merged.second)) {
+		merged.first = qMin(merged.first, last->first);
+		merged.second = qMax(merged.second, last->second);
+		++last;
+	}
+	intervals.insert(intervals.erase(first, last), merged);
+}
+
+qint64 SharedHistory::getActivity(const QDate &date) const
+{
+	const auto day = activity_per_day_.find(date.toJulianDay());
+	if (day == activity_per_day_.end())
+		return 0;
+
+	qint64 sum = 0;
+	for (const Interval &interval : day->second)
+		sum += interval.second - interval.first;
+	return sum;
+}
+
+qint64 SharedHistory::getActivity(const QDate &date, const std::vector<TimeSegment> &running_segments) const
+{
+	// The running session is only in the shared files once it is stopped, but it counts for today as well
+	const auto day = activity_per_day_.find(date.toJulianDay());
+	std::vector<Interval> intervals = (day != activity_per_day_.end()) ? day->second : std::vector<Interval>();
+	for (const TimeSegment &segment : running_segments)
+		if ((segment.type == SegmentType::Activity) && (segment.duration > 0) && (HistoryStore::getDayNumber(segment.start, settings_.getDayStartHour()) == date.toJulianDay()))
+			addActivity(intervals, Interval(segment.start, segment.start + segment.duration));
+
+	qint64 sum = 0;
+	for (const Interval &interval : intervals)
+		sum += interval.second - interval.first;
+	return sum;
+}
+
+QStringList SharedHistory::getMachines() const
+{
+	QStringList machines;
+	for (size_t id = 0; id < machines_.size(); ++id)
+		machines << machines_.getString(static_cast<quint16>(id));
+	return machines;
+}
+
+void SharedHistory::emitToday()
+{
+	emit mergedActivityChanged(getActivity(getWorkToday(settings_.getDayStartHour())));
+}
@@ -0,0 +1,75 @@
+#ifndef SHAREDHISTORY_H
+#define SHAREDHISTORY_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QDate>
+#include <QDir>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <map>
+#include <utility>
+#include <vector>
+#include "settings.h"
+#include "stringinterner.h"
+#include "types.h"
+
+// History of several machines in a shared folder. Every machine only appends its own segments to
+// <machine>.segments there, each record numbered by a sequence number of that machine. Merging is the
+// union of all records keyed by (machine, sequence number), so it gives the same result in any order
+// and no matter how often a file is read. Since a machine's records are numbered without gaps, that
+// union is kept as the count merged per machine. Only the part of a file after the last merged offset
+// is read, and only recent days are kept. Offsets, counts and day unions are kept in a local state
+// file, so a restart only reads what was appended to the shared files in the meantime.
+class SharedHistory : public QObject
+{
+	Q_OBJECT
+	friend class SoakTest;
+
+private:
+	typedef std::pair<qint64, qint64> Interval;	// [start, end) msec since epoch
+
+	const Settings & settings_;
+	QString state_filename_;
+	QDir folder_;
+	QString machine_;
+	QFile own_file_;
+	quint64 next_seq_;
+	StringInterner machines_;
+	QHash<QString, qint64> offsets_;	// by file name, bytes merged so far
+	std::vector<quint64> merged_counts_;	// by machine id, records 0 .. count-1 are merged
+	std::map<qint64, std::vector<Interval>> activity_per_day_;	// by day number, all machines, sorted and disjoint
+	QFileSystemWatcher watcher_;
+	QTimer rescan_timer_;
+
+	bool openOwnFile();
+	bool loadState();
+	void saveState() const;
+	bool mergeFile(const QString &path);
+	static void addActivity(std::vector<Interval> &intervals, const Interval &interval);
+
+private slots:
+	void mergeOnStart();
+	void emitToday();
+
+public:
+	explicit SharedHistory(const Settings & settings, const QString &state_filename, QObject *parent = nullptr);
+	bool isEnabled() const;
+	qint64 getActivity(const QDate &date) const;
+	qint64 getActivity(const QDate &date, const std::vector<TimeSegment> &running_segments) const;
+	QStringList getMachines() const;
+
+signals:
+	void mergedActivityChanged(qint64 t_today);
+
+public slots:
+	void addSession(const std::vector<TimeSegment> &segments);
+	void mergeAll();
+	void mergeChangedFile(const QString &path);
+};
+
+#endif // SHAREDHISTORY_H
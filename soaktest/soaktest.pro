@@ -0,0 +1,42 @@
+TARGET = soaktest
+
+HEADERS = \
+   $$PWD/../timetracker.h \
+   $$PWD/../clock.h \
+   $$PWD/../sharedhistory.h \
+   $$PWD/../foregroundwatcher.h \
+   $$PWD/../historystore.h \
+   $$PWD/../projects.h \
+   $$PWD/../stringinterner.h \
+   $$PWD/../settings.h \
+   $$PWD/../metrics.h \
+   $$PWD/../types.h \
+   $$PWD/../helpers.h \
+   $$PWD/../logger.h
+
+SOURCES = \
+   $$PWD/tst_soak.cpp \
+   $$PWD/../timetracker.cpp \
+   $$PWD/../clock.cpp \
+   $$PWD/../sharedhistory.cpp \
+   $$PWD/../foregroundwatcher.cpp \
+   $$PWD/../historystore.cpp \
+   $$PWD/../projects.cpp \
+   $$PWD/../stringinterner.cpp \
+   $$PWD/../settings.cpp \
+   $$PWD/../metrics.cpp \
+   $$PWD/../helpers.cpp \
+   $$PWD/../logger.cpp
+
+INCLUDEPATH = \
+    $$PWD/..
+
+TEMPLATE = app
+
+CONFIG += console testcase c++14
+CONFIG -= app_bundle
+
+QT -= gui
+QT += network testlib
+
+LIBS += -lUser32 -lPsapi
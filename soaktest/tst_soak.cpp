@@ -0,0 +1,299 @@
+#include <QtTest>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+#include <QString>
+#include <QTemporaryDir>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <Windows.h>
+#include <Psapi.h>
+
+#include "settings.h"
+#include "projects.h"
+#include "timetracker.h"
+#include "sharedhistory.h"
+#include "foregroundwatcher.h"
+#include "clock.h"
+#include "helpers.h"
+#include "types.h"
+
+// Every allocation through new is counted, so the soak test can tell whether the number of live
+// allocations grows over the simulated year
+namespace {
+	std::atomic<qint64> live_allocations(0);
+}
+
+void * operator new(std::size_t size)
+{
+	void *pointer = std::malloc((size > 0) ? size : 1);
+	if (pointer == nullptr)
+		throw std::bad_alloc();
+	++live_allocations;
+	return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+	if (pointer == nullptr)
+		return;
+	--live_allocations;
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t /* size */) noexcept
+{
+	operator delete(pointer);
+}
+
+namespace {
+	const int simulated_days = 400;
+	const int warmup_days = 30;
+	const int transitions_per_day = 200;
+	const size_t max_segments_per_day = 4 * transitions_per_day + 4;	// sleep, activity, pause and project split per transition
+	const qint64 msec_per_day = 24 * Q_INT64_C(3600000);
+	const qint64 step_msec = 3 * 60000;
+	const qint64 sleep_msec = 5 * 60000;
+	const qint64 lock_msec = 20 * 60000;
+	const qint64 max_allocation_growth = 1000;
+	const qint64 max_working_set_growth = 8 * 1024 * 1024;
+	const int segments_per_session = 16;
+	const qint64 segment_msec = 10 * 60000;
+	const size_t kept_days = 62;	// as in sharedhistory.cpp
+	const int app_switches = 200000;
+	const int distinct_apps = 70000;	// more than the interner takes
+	const size_t max_apps = 0xffff;
+
+	// A shared history file as another machine writes it, see sharedhistory.cpp
+	struct SharedFileHeader
+	{
+		quint32 magic;
+		quint32 version;
+	};
+
+	struct SharedRecord
+	{
+		quint64 seq;
+		qint64 start;
+		qint64 duration;
+		quint32 type;
+		quint32 reserved;
+	};
+
+	// Only moves when the test moves it; the monotonic and the wall clock move together, as long as
+	// nobody sets the wall clock
+	class VirtualClock : public Clock
+	{
+	private:
+		qint64 t_mono_;
+		qint64 t_wall_;
+
+	public:
+		explicit VirtualClock(const qint64 t_wall) : t_mono_(0), t_wall_(t_wall) { }
+		qint64 getMonotonicMSec() const override { return t_mono_; }
+		qint64 getWallMSec() const override { return t_wall_; }
+		void advance(const qint64 msec) { t_mono_ += msec; t_wall_ += msec; }
+	};
+
+	qint64 getPeakWorkingSet()
+	{
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+		return static_cast<qint64>(counters.PeakWorkingSetSize);
+	}
+
+	bool writeSharedFile(const QString &path, const int record_count, const qint64 t_start, const qint64 duration)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			return false;
+		const SharedFileHeader header{0x48535455, 1};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for (int i = 0; i < record_count; ++i) {
+			const SharedRecord record{static_cast<quint64>(i), t_start + 2 * i * duration, duration, static_cast<quint32>(SegmentType::Activity), 0};
+			file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+		}
+		return file.flush();
+	}
+}
+
+// Drives the components of a long-running instance with a year of synthetic events and checks that
+// what they keep in memory stays bounded. Everything is written to a temporary folder.
+class SoakTest : public QObject
+{
+	Q_OBJECT
+
+private:
+	QTemporaryDir dir_;
+	QString settings_name_;
+	QString shared_folder_;
+
+private slots:
+	void initTestCase();
+	void timeTrackerSegments();
+	void sharedHistoryDays();
+	void sharedHistoryRecreatedFile();
+	void foregroundWatcherApps();
+};
+
+void SoakTest::initTestCase()
+{
+	QVERIFY(dir_.isValid());
+	shared_folder_ = dir_.filePath("shared");
+	QVERIFY(QDir().mkpath(shared_folder_));
+
+	settings_name_ = dir_.filePath("user-settings.ini");
+	QSettings ini(settings_name_, QSettings::IniFormat);
+	ini.setValue("uTimer/debug_log_to_file", false);
+	ini.setValue("uTimer/track_foreground_applications", true);
+	ini.setValue("uTimer/shared_history_folder_or_empty", shared_folder_);
+	ini.setValue("uTimer/autopause_enabled", true);
+	ini.setValue("uTimer/count_system_sleep_as_pause", true);
+	ini.setValue("uTimer/restart_timer_at_day_start", true);
+	ini.sync();
+}
+
+// A year of work days on a virtual clock: button presses, sleeps, locks and project switches. The
+// totals have to match the time spent in each mode exactly, and neither the live allocations nor
+// the peak working set may grow once the first month has been simulated.
+void SoakTest::timeTrackerSegments()
+{
+	Settings settings(settings_name_);
+	Projects projects(settings, dir_.filePath("projects.txt"));
+	VirtualClock clock(QDateTime::currentMSecsSinceEpoch() - simulated_days * msec_per_day);
+	TimeTracker time_tracker(settings, projects, clock);
+	qint64 allocations_after_warmup = 0;
+	qint64 working_set_after_warmup = 0;
+
+	// The day start restarts the timer, so only the first day needs the button
+	time_tracker.useTimerViaButton(Button::Start);
+	for (int day = 0; day < simulated_days; ++day) {
+		const qint64 t_day = clock.getWallMSec();
+		qint64 t_active = 0;
+		qint64 t_pause = 0;
+		for (int i = 0; i < transitions_per_day; ++i) {
+			const bool active = (time_tracker.getMode() == TimeTracker::Mode::Activity);
+			clock.advance(step_msec);
+			(active ? t_active : t_pause) += step_msec;
+
+			if (i % 10 == 3) {
+				const qint64 t_suspend = clock.getMonotonicMSec();
+				clock.advance(sleep_msec);
+				time_tracker.useTimerViaSleepEvent(t_suspend, clock.getMonotonicMSec(), sleep_msec);
+				t_pause += sleep_msec;
+			}
+			else if ((i % 10 == 7) && active) {
+				// Locked long enough for the autopause, which takes the locked time back from the Activity
+				clock.advance(lock_msec);
+				time_tracker.useTimerViaLockEvent(LockEvent::LongOngoingLock, lock_msec);
+				time_tracker.useTimerViaLockEvent(LockEvent::Unlock, 0);
+				t_pause += lock_msec;
+			}
+			else {
+				time_tracker.useTimerViaButton(active ? Button::Pause : Button::Start);
+			}
+			time_tracker.useTimerViaProject("Project " + QString::number(i % 3));
+
+			QCOMPARE(time_tracker.getActiveTime(), t_active);
+			QCOMPARE(time_tracker.getPauseTime(), t_pause);
+			QCOMPARE(time_tracker.getSegmentStart(), clock.getWallMSec());
+		}
+
+		qint64 t_segments = 0;
+		for (const TimeSegment &segment : time_tracker.getSegments())
+			t_segments += segment.duration;
+		QCOMPARE(t_segments, t_active + t_pause);
+		QCOMPARE(clock.getWallMSec() - t_day, t_active + t_pause);
+		QVERIFY(time_tracker.getSegments().size() <= max_segments_per_day);
+
+		clock.advance(msec_per_day - (clock.getWallMSec() - t_day));
+		time_tracker.useTimerViaDayStart();
+		QVERIFY(time_tracker.getMode() != TimeTracker::Mode::None);
+
+		if (day == warmup_days) {
+			allocations_after_warmup = live_allocations;
+			working_set_after_warmup = getPeakWorkingSet();
+			QVERIFY(working_set_after_warmup > 0);
+		}
+		else if (day > warmup_days) {
+			QVERIFY(live_allocations <= allocations_after_warmup + max_allocation_growth);
+		}
+	}
+	QVERIFY(getPeakWorkingSet() - working_set_after_warmup <= max_working_set_growth);
+	time_tracker.useTimerViaButton(Button::Stop);
+}
+
+void SoakTest::sharedHistoryDays()
+{
+	Settings settings(settings_name_);
+	SharedHistory shared_history(settings, dir_.filePath("shared-history.dat"));
+	QVERIFY(shared_history.isEnabled());
+
+	const int day_start_hour = settings.getDayStartHour();
+	const QDate today = getWorkToday(day_start_hour);
+	for (int day = simulated_days; day >= 0; --day) {
+		const qint64 t_day = getWorkDayStartMSec(today.addDays(-day), day_start_hour) + 3600000;
+		std::vector<TimeSegment> segments;
+		for (int i = 0; i < segments_per_session; ++i)
+			segments.push_back(TimeSegment{(i % 2 == 0) ? SegmentType::Activity : SegmentType::Pause, t_day + i * segment_msec, segment_msec, 0});
+		shared_history.addSession(segments);
+
+		QVERIFY(shared_history.activity_per_day_.size() <= kept_days);
+		for (const auto &intervals : shared_history.activity_per_day_)
+			QVERIFY(intervals.second.size() <= static_cast<size_t>(segments_per_session / 2));
+	}
+	QCOMPARE(shared_history.merged_counts_.size(), static_cast<size_t>(1));
+	QCOMPARE(shared_history.getActivity(today), (segments_per_session / 2) * segment_msec);
+}
+
+void SoakTest::sharedHistoryRecreatedFile()
+{
+	Settings settings(settings_name_);
+	SharedHistory shared_history(settings, dir_.filePath("recreated-state.dat"));
+	QVERIFY(shared_history.isEnabled());
+
+	const int day_start_hour = settings.getDayStartHour();
+	const QDate today = getWorkToday(day_start_hour);
+	const qint64 t_day = getWorkDayStartMSec(today, day_start_hour);
+	const QString path = QDir(shared_folder_).filePath("other.segments");
+
+	QVERIFY(writeSharedFile(path, 10, t_day + 6 * 3600000, 60000));
+	shared_history.mergeAll();
+	const qint64 t_before = shared_history.getActivity(today);
+
+	// The other machine lost its file and starts over, numbering its records from 0 again
+	QVERIFY(writeSharedFile(path, 3, t_day + 12 * 3600000, 60000));
+	shared_history.mergeAll();
+	QCOMPARE(shared_history.getActivity(today) - t_before, 3 * Q_INT64_C(60000));
+	QCOMPARE(shared_history.merged_counts_.size(), static_cast<size_t>(2));
+}
+
+void SoakTest::foregroundWatcherApps()
+{
+	Settings settings(settings_name_);
+	ForegroundWatcher foreground_watcher(settings);
+
+	for (int session = 0; session < 3; ++session) {
+		const qint64 t_start = QDateTime::currentMSecsSinceEpoch();
+		foreground_watcher.reactOnModeChange(TimeTracker::Mode::Activity);
+		for (int i = 0; i < app_switches; ++i)
+			foreground_watcher.registerApp("app" + QString::number(i % distinct_apps) + ".exe");
+		QVERIFY(foreground_watcher.switches_.size() <= static_cast<size_t>(app_switches) + 1);
+		foreground_watcher.reactOnModeChange(TimeTracker::Mode::None);
+		const qint64 t_stop = QDateTime::currentMSecsSinceEpoch() + 1;
+		foreground_watcher.addSession(std::vector<TimeSegment>{TimeSegment{SegmentType::Activity, t_start, t_stop - t_start, 0}});
+
+		QVERIFY(foreground_watcher.switches_.empty());
+		QVERIFY(foreground_watcher.apps_.size() <= max_apps);
+		QVERIFY(foreground_watcher.app_totals_.size() <= foreground_watcher.apps_.size());
+	}
+}
+
+QTEST_GUILESS_MAIN(SoakTest)
+
+#include "tst_soak.moc"
@@ -0,0 +1,27 @@
+#include "startupprofiler.h"
+#include "logger.h"
+
+StartupProfiler::StartupProfiler() : last_mark_(0)
+{
+	timer_.start();
+}
+
+void StartupProfiler::mark(const QString &phase)
+{
+	// Only collected here; logging right away would make the log file part of every phase
+	const qint64 t_now = timer_.elapsed();
+	phases_ += phase + " " + QString::number(t_now - last_mark_) + "ms, ";
+	last_mark_ = t_now;
+}
+
+void StartupProfiler::markMilestone(const QString &milestone)
+{
+	// Time since the start rather than since the last mark, and no new phase begins here
+	phases_ += milestone + " at " + QString::number(timer_.elapsed()) + "ms, ";
+}
+
+void StartupProfiler::log(const Settings &settings) const
+{
+	if (settings.logToFile())
+		Logger::Log("[STARTUP] " + phases_ + "Total " + QString::number(last_mark_) + "ms");
+}
@@ -0,0 +1,24 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include <QString>
+#include "settings.h"
+
+
+class StartupProfiler
+{
+private:
+	QElapsedTimer timer_;
+	qint64 last_mark_;
+	QString phases_;
+
+public:
+	StartupProfiler();
+	void mark(const QString &phase);
+	void markMilestone(const QString &milestone);
+	void log(const Settings &settings) const;
+};
+
+#endif // STARTUPPROFILER_H
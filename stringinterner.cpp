@@ -0,0 +1,38 @@
+#include "stringinterner.h"
+
+namespace {
+	const size_t max_strings = 0xffff;
+	const QString unknown_string = "?";
+}
+
+bool StringInterner::intern(const QString &string, quint16 &id)
+{
+	if (find(string, id))
+		return true;
+	if (strings_.size() >= max_strings)
+		return false;
+
+	id = static_cast<quint16>(strings_.size());
+	strings_.push_back(string);
+	ids_.insert(string, id);
+	return true;
+}
+
+bool StringInterner::find(const QString &string, quint16 &id) const
+{
+	const auto it = ids_.constFind(string);
+	if (it == ids_.constEnd())
+		return false;
+	id = it.value();
+	return true;
+}
+
+const QString & StringInterner::getString(const quint16 id) const
+{
+	return ((id < strings_.size()) ? strings_[id] : unknown_string);
+}
+
+size_t StringInterner::size() const
+{
+	return strings_.size();
+}
@@ -0,0 +1,24 @@
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#include <QtGlobal>
+#include <QHash>
+#include <QString>
+#include <vector>
+
+// Hands out a small, stable id per distinct string in order of first appearance, so that records
+// store two bytes instead of a string and lookups by id are a plain index
+class StringInterner
+{
+private:
+	QHash<QString, quint16> ids_;
+	std::vector<QString> strings_;
+
+public:
+	bool intern(const QString &string, quint16 &id);
+	bool find(const QString &string, quint16 &id) const;
+	const QString & getString(const quint16 id) const;
+	size_t size() const;
+};
+
+#endif // STRINGINTERNER_H
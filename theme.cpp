@@ -0,0 +1,65 @@
+#include "theme.h"
+#include <QApplication>
+#include <QStyle>
+#include <QColor>
+
+Theme::Theme(const Settings &settings)
+{
+	const bool dark = (settings.getThemeName() == "dark");
+
+	window_palette_ = dark ? createDarkPalette() : QApplication::style()->standardPalette();
+
+	label_palette_ = window_palette_;
+	running_label_palette_ = window_palette_;
+	running_label_palette_.setColor(QPalette::WindowText, dark ? QColor(110,200,110) : QColor(0,128,0));
+
+	button_palette_ = window_palette_;
+	held_button_palette_ = window_palette_;
+	held_button_palette_.setColor(QPalette::Button, dark ? QColor(45,95,120) : QColor(180,216,228));
+
+	segment_colors_[static_cast<size_t>(SegmentType::Activity)] = dark ? QColor(110,200,110) : QColor(0,160,0);
+	segment_colors_[static_cast<size_t>(SegmentType::Pause)] = dark ? QColor(220,170,70) : QColor(240,170,30);
+	segment_colors_[static_cast<size_t>(SegmentType::Autopause)] = dark ? QColor(200,130,200) : QColor(190,100,190);
+	segment_colors_[static_cast<size_t>(SegmentType::Sleep)] = dark ? QColor(110,110,110) : QColor(170,170,170);
+}
+
+QPalette Theme::createDarkPalette()
+{
+	QPalette palette;
+	palette.setColor(QPalette::Window, QColor(53,53,53));
+	palette.setColor(QPalette::WindowText, QColor(225,225,225));
+	palette.setColor(QPalette::Base, QColor(35,35,35));
+	palette.setColor(QPalette::AlternateBase, QColor(53,53,53));
+	palette.setColor(QPalette::ToolTipBase, QColor(25,25,25));
+	palette.setColor(QPalette::ToolTipText, QColor(225,225,225));
+	palette.setColor(QPalette::Text, QColor(225,225,225));
+	palette.setColor(QPalette::Button, QColor(53,53,53));
+	palette.setColor(QPalette::ButtonText, QColor(225,225,225));
+	palette.setColor(QPalette::BrightText, QColor(255,80,80));
+	palette.setColor(QPalette::Highlight, QColor(42,130,218));
+	palette.setColor(QPalette::HighlightedText, QColor(35,35,35));
+	palette.setColor(QPalette::Disabled, QPalette::WindowText, QColor(127,127,127));
+	palette.setColor(QPalette::Disabled, QPalette::Text, QColor(127,127,127));
+	palette.setColor(QPalette::Disabled, QPalette::ButtonText, QColor(127,127,127));
+	return palette;
+}
+
+const QPalette & Theme::getWindowPalette() const
+{
+	return window_palette_;
+}
+
+const QPalette & Theme::getLabelPalette(const bool running) const
+{
+	return (running ? running_label_palette_ : label_palette_);
+}
+
+const QPalette & Theme::getButtonPalette(const bool held) const
+{
+	return (held ? held_button_palette_ : button_palette_);
+}
+
+const QColor & Theme::getSegmentColor(const SegmentType type) const
+{
+	return segment_colors_[static_cast<size_t>(type)];
+}
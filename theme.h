@@ -0,0 +1,32 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QPalette>
+#include <QColor>
+#include <array>
+#include "settings.h"
+#include "types.h"
+
+// All colors the GUI switches between, built once. Switching a widget's state is then only a
+// palette assignment, where style sheets would be parsed and the widget re-polished every time.
+class Theme
+{
+private:
+	QPalette window_palette_;
+	QPalette label_palette_;
+	QPalette running_label_palette_;
+	QPalette button_palette_;
+	QPalette held_button_palette_;
+	std::array<QColor, 4> segment_colors_;
+
+	static QPalette createDarkPalette();
+
+public:
+	explicit Theme(const Settings & settings);
+	const QPalette & getWindowPalette() const;
+	const QPalette & getLabelPalette(const bool running) const;
+	const QPalette & getButtonPalette(const bool held) const;
+	const QColor & getSegmentColor(const SegmentType type) const;
+};
+
+#endif // THEME_H
@@ -0,0 +1,44 @@
+#include "tickwatchdog.h"
+#include "logger.h"
+#include "metrics.h"
+
+TickWatchdog::TickWatchdog(const Settings &settings, const qint64 interval_msec, QObject *parent)
+	: QObject(parent),
+		settings_(settings),
+		interval_msec_(interval_msec),
+		stall_threshold_msec_(10 * interval_msec),
+		stall_count_(0),
+		stall_total_msec_(0),
+		stall_max_msec_(0)
+{
+	tick_timer_.invalidate();
+}
+
+TickWatchdog::~TickWatchdog()
+{
+	if (settings_.logToFile() && (stall_count_ > 0))
+		Logger::Log("[STALL] " + QString::number(stall_count_) + " Event Loop Stalls, Total = " + QString::number(stall_total_msec_) + "ms, Longest = " + QString::number(stall_max_msec_) + "ms");
+}
+
+void TickWatchdog::update()
+{
+	if (!tick_timer_.isValid()) {
+		tick_timer_.start();
+		return;
+	}
+
+	// A tick arriving much later than its interval means the event loop was blocked (nested
+	// event loop, heavy load, debugger); everything sampled on ticks saw the world late by t_stall
+	const qint64 t_stall = tick_timer_.restart() - interval_msec_;
+	Metrics::observeTickLatency(t_stall);
+	if (t_stall < stall_threshold_msec_)
+		return;
+
+	Metrics::count(Metrics::Counter::EventLoopStalls);
+	Metrics::count(Metrics::Counter::EventLoopStallMsec, static_cast<quint64>(t_stall));
+	++stall_count_;
+	stall_total_msec_ += t_stall;
+	stall_max_msec_ = qMax(stall_max_msec_, t_stall);
+	if (settings_.logToFile())
+		Logger::Log("[STALL] Event Loop stalled for " + QString::number(t_stall) + "ms");
+}
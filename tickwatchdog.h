@@ -0,0 +1,31 @@
+#ifndef TICKWATCHDOG_H
+#define TICKWATCHDOG_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include "settings.h"
+
+
+class TickWatchdog : public QObject
+{
+	Q_OBJECT
+
+private:
+	const Settings & settings_;
+	QElapsedTimer tick_timer_;
+	const qint64 interval_msec_;
+	const qint64 stall_threshold_msec_;
+	qint64 stall_count_;
+	qint64 stall_total_msec_;
+	qint64 stall_max_msec_;
+
+public:
+	explicit TickWatchdog(const Settings & settings, const qint64 interval_msec, QObject *parent = nullptr);
+	~TickWatchdog();
+
+public slots:
+	void update();
+};
+
+#endif // TICKWATCHDOG_H
@@ -0,0 +1,150 @@
+#include "timelinewidget.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include "helpers.h"
+
+namespace {
+	const int bar_top = 2;
+	const int scale_height = 12;
+}
+
+TimelineWidget::TimelineWidget(const Theme &theme, QWidget *parent)
+	: QWidget(parent),
+		theme_(theme),
+		day_start_hour_(0),
+		day_start_(0),
+		day_end_(1),
+		tail_(TimeSegment{SegmentType::Activity, 0, 0, 0}),
+		has_tail_(false),
+		tail_painted_x_(0),
+		cache_valid_(false)
+{
+	setMinimumHeight(32);
+	setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+QDate TimelineWidget::getDate() const
+{
+	return date_;
+}
+
+void TimelineWidget::setDay(const QDate &date, const int day_start_hour, const std::vector<TimeSegment> &segments)
+{
+	date_ = date;
+	day_start_hour_ = day_start_hour;
+	day_start_ = date.isValid() ? getWorkDayStartMSec(date, day_start_hour) : 0;
+	day_end_ = date.isValid() ? getWorkDayStartMSec(date.addDays(1), day_start_hour) : 1;
+	segments_ = segments;
+	has_tail_ = false;
+	cache_valid_ = false;
+	update();
+}
+
+void TimelineWidget::addSegment(const TimeSegment &segment)
+{
+	if ((segment.duration <= 0) || (segment.start + segment.duration <= day_start_) || (segment.start >= day_end_))
+		return;
+
+	segments_.push_back(segment);
+	if (!cache_valid_)
+		return;
+
+	const int x_start = getX(segment.start);
+	const int x_end = getX(segment.start + segment.duration);
+	QPainter painter(&cache_);
+	paintBar(painter, x_start, x_end, segment.type);
+	update(x_start, 0, x_end - x_start + 1, height());
+}
+
+void TimelineWidget::setTail(const SegmentType type, const qint64 start, const qint64 end)
+{
+	const bool same_tail = has_tail_ && (tail_.type == type) && (tail_.start == start);
+	tail_ = TimeSegment{type, start, end - start, 0};
+	has_tail_ = true;
+	if (!cache_valid_)
+		return;
+
+	// Most ticks don't move the tail by a whole pixel, and then there is nothing to paint at all
+	const int x_end = getX(end);
+	if (same_tail && (x_end == tail_painted_x_))
+		return;
+
+	const int x_start = same_tail ? tail_painted_x_ : getX(start);
+	QPainter painter(&cache_);
+	paintBar(painter, x_start, x_end, type);
+	tail_painted_x_ = x_end;
+	update(x_start, 0, x_end - x_start + 1, height());
+}
+
+void TimelineWidget::clearTail()
+{
+	has_tail_ = false;
+}
+
+QSize TimelineWidget::sizeHint() const
+{
+	return QSize(400, 40);
+}
+
+int TimelineWidget::getX(const qint64 msecs) const
+{
+	const qint64 clamped = qBound(day_start_, msecs, day_end_);
+	return static_cast<int>((clamped - day_start_) * width() / (day_end_ - day_start_));
+}
+
+int TimelineWidget::getBarHeight() const
+{
+	return qMax(1, height() - bar_top - scale_height);
+}
+
+void TimelineWidget::paintBar(QPainter &painter, const int x_start, const int x_end, const SegmentType type) const
+{
+	painter.fillRect(x_start, bar_top, qMax(1, x_end - x_start), getBarHeight(), theme_.getSegmentColor(type));
+}
+
+void TimelineWidget::renderCache()
+{
+	cache_ = QPixmap(size());
+	const QPalette &palette = theme_.getWindowPalette();
+	cache_.fill(palette.color(QPalette::Window));
+
+	QPainter painter(&cache_);
+	painter.fillRect(0, bar_top, width(), getBarHeight(), palette.color(QPalette::Base));
+	for (const TimeSegment &segment : segments_)
+		paintBar(painter, getX(segment.start), getX(segment.start + segment.duration), segment.type);
+	if (has_tail_) {
+		tail_painted_x_ = getX(tail_.start + tail_.duration);
+		paintBar(painter, getX(tail_.start), tail_painted_x_, tail_.type);
+	}
+
+	// Hour ticks from the day start on, labeled every 6 hours
+	const int scale_top = bar_top + getBarHeight();
+	painter.setPen(palette.color(QPalette::WindowText));
+	QFont font = painter.font();
+	font.setPointSize(7);
+	painter.setFont(font);
+	for (int hour = 0; hour <= 24; ++hour) {
+		const int x = qMin(width() - 1, hour * width() / 24);
+		painter.drawLine(x, scale_top, x, scale_top + ((hour % 6 == 0) ? 4 : 2));
+		if ((hour % 6 == 0) && (hour < 24))
+			painter.drawText(x + 2, height() - 1, QString::number((day_start_hour_ + hour) % 24));
+	}
+
+	cache_valid_ = true;
+}
+
+void TimelineWidget::paintEvent(QPaintEvent *event)
+{
+	if (!cache_valid_ || (cache_.size() != size()))
+		renderCache();
+
+	QPainter painter(this);
+	painter.drawPixmap(event->rect(), cache_, event->rect());
+}
+
+void TimelineWidget::resizeEvent(QResizeEvent *event)
+{
+	cache_valid_ = false;
+	QWidget::resizeEvent(event);
+}
@@ -0,0 +1,51 @@
+#ifndef TIMELINEWIDGET_H
+#define TIMELINEWIDGET_H
+
+#include <QWidget>
+#include <QDate>
+#include <QPixmap>
+#include <QSize>
+#include <vector>
+#include "theme.h"
+#include "types.h"
+
+// The segments of one work day as colored bars over its 24 hours. Everything is rendered into a cached pixmap:
+// new segments and the growing tail of the running segment are painted onto it, and only the
+// pixels they changed are repainted. The whole pixmap is only rebuilt on resize or a new day.
+class TimelineWidget : public QWidget
+{
+	Q_OBJECT
+
+private:
+	const Theme & theme_;
+	QDate date_;
+	int day_start_hour_;
+	qint64 day_start_;
+	qint64 day_end_;
+	std::vector<TimeSegment> segments_;
+	TimeSegment tail_;
+	bool has_tail_;
+	int tail_painted_x_;
+	QPixmap cache_;
+	bool cache_valid_;
+
+	int getX(const qint64 msecs) const;
+	int getBarHeight() const;
+	void paintBar(QPainter &painter, const int x_start, const int x_end, const SegmentType type) const;
+	void renderCache();
+
+protected:
+	void paintEvent(QPaintEvent *event) override;
+	void resizeEvent(QResizeEvent *event) override;
+
+public:
+	explicit TimelineWidget(const Theme & theme, QWidget *parent = nullptr);
+	QDate getDate() const;
+	void setDay(const QDate &date, const int day_start_hour, const std::vector<TimeSegment> &segments);
+	void addSegment(const TimeSegment &segment);
+	void setTail(const SegmentType type, const qint64 start, const qint64 end);
+	void clearTail();
+	QSize sizeHint() const override;
+};
+
+#endif // TIMELINEWIDGET_H
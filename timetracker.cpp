@@ -1,10 +1,16 @@
 #include "timetracker.h"
 #include <QtDebug>
 #include <QDateTime>
+#include <iterator>
 #include "logger.h"
 #include "helpers.h"
+#include "metrics.h"
 
-TimeTracker::TimeTracker(const Settings &settings, QObject *parent) : QObject(parent), settings_(settings), mode_(Mode::None), was_active_before_autopause_(false)
+namespace {
+	const qint64 clock_jump_tolerance_msec = 2000;
+}
+
+TimeTracker::TimeTracker(const Settings &settings, Projects &projects, const Clock &clock, QObject *parent) : QObject(parent), settings_(settings), projects_(projects), clock_(clock), t_segment_mono_(0), timer_offset_(0), segment_start_(0), t_closed_active_(0), t_closed_pause_(0), project_(0), mode_(Mode::None), was_active_before_autopause_(false), rolling_over_(false)
 { }
 
 TimeTracker::~TimeTracker()
@@ -12,20 +18,184 @@ TimeTracker::~TimeTracker()
 	stopTimer();
 }
 
-void TimeTracker::startTimer()
+qint64 TimeTracker::getSegmentDuration() const
+{
+	return (clock_.getMonotonicMSec() - t_segment_mono_ + timer_offset_);
+}
+
+SegmentType TimeTracker::getSegmentType() const
+{
+	return ((mode_ == Mode::Activity) ? SegmentType::Activity : SegmentType::Pause);
+}
+
+void TimeTracker::setMode(const Mode mode)
+{
+	mode_ = mode;
+	emit modeChanged(mode);
+}
+
+void TimeTracker::emitTransition(const Transition transition)
+{
+	// Stopping and restarting at the day start only splits the session, it is no transition of the user's
+	if (rolling_over_)
+		return;
+	emit transitioned(transition, getActiveTime(), getPauseTime(), getProjectName());
+}
+
+void TimeTracker::addSegment(const SegmentType type, const qint64 duration)
+{
+	const TimeSegment segment{type, segment_start_, duration, project_};
+	segment_start_ += duration;
+	if (duration <= 0)
+		return;
+
+	putSegment(coalesceWithPrevious(segment));
+	emit segmentAdded(segment);
+}
+
+TimeSegment TimeTracker::coalesceWithPrevious(const TimeSegment &segment)
+{
+	// A seamless continuation of the same kind is stored as one, e.g. the Activity around a sleep
+	// counted as Activity. The day rollover bounds everything else, a session is at most a day
+	const auto next = segments_.lower_bound(segment.start);
+	if (next == segments_.begin())
+		return segment;
+	const auto previous = std::prev(next);
+	const TimeSegment &before = previous->second;
+	if ((before.type != segment.type) || (before.project != segment.project) || (before.start + before.duration != segment.start))
+		return segment;
+
+	const TimeSegment merged{segment.type, before.start, before.duration + segment.duration, segment.project};
+	takeSegment(previous);
+	return merged;
+}
+
+void TimeTracker::putSegment(const TimeSegment &segment)
+{
+	segments_[segment.start] = segment;
+	addToTotals(segment, 1);
+}
+
+std::map<qint64, TimeSegment>::iterator TimeTracker::takeSegment(std::map<qint64, TimeSegment>::iterator it)
+{
+	addToTotals(it->second, -1);
+	return segments_.erase(it);
+}
+
+void TimeTracker::addToTotals(const TimeSegment &segment, const qint64 sign)
+{
+	if (segment.project >= project_totals_.size())
+		project_totals_.resize(segment.project + 1, ProjectTotals{0, 0});
+
+	ProjectTotals &project_totals = project_totals_[segment.project];
+	if (segment.type == SegmentType::Activity) {
+		t_closed_active_ += sign * segment.duration;
+		project_totals.active += sign * segment.duration;
+	}
+	else {
+		t_closed_pause_ += sign * segment.duration;
+		project_totals.pause += sign * segment.duration;
+	}
+}
+
+void TimeTracker::eraseRange(const qint64 from, const qint64 to)
+{
+	// Only the segment before the first one starting in range can reach into it
+	auto it = segments_.lower_bound(from);
+	if (it != segments_.begin()) {
+		const auto previous = std::prev(it);
+		if (previous->second.start + previous->second.duration > from)
+			it = previous;
+	}
+
+	while ((it != segments_.end()) && (it->second.start < to)) {
+		const TimeSegment segment = it->second;
+		const qint64 end = segment.start + segment.duration;
+		it = takeSegment(it);
+		if (segment.start < from)
+			putSegment(TimeSegment{segment.type, segment.start, from - segment.start, segment.project});
+		if (end > to)
+			putSegment(TimeSegment{segment.type, to, end - to, segment.project});
+	}
+}
+
+std::vector<TimeSegment> TimeTracker::splitByProject(const qint64 from, const qint64 to, const SegmentType type) const
+{
+	// One piece per run of segments with the same project; a gap goes to the project before it
+	auto it = segments_.lower_bound(from);
+	quint16 project = project_;
+	if (it != segments_.begin()) {
+		const auto previous = std::prev(it);
+		project = previous->second.project;
+		if (previous->second.start + previous->second.duration > from)
+			it = previous;
+	}
+
+	std::vector<TimeSegment> pieces;
+	qint64 t_piece = from;
+	for (; (it != segments_.end()) && (it->second.start < to); ++it) {
+		if (it->second.project == project)
+			continue;
+		const qint64 t_split = qMax(from, it->second.start);
+		if (t_split > t_piece)
+			pieces.push_back(TimeSegment{type, t_piece, t_split - t_piece, project});
+		t_piece = t_split;
+		project = it->second.project;
+	}
+	pieces.push_back(TimeSegment{type, t_piece, to - t_piece, project});
+	return pieces;
+}
+
+qint64 TimeTracker::getStoredEnd() const
+{
+	if (segments_.empty())
+		return 0;
+	const TimeSegment &last = segments_.rbegin()->second;
+	return (last.start + last.duration);
+}
+
+void TimeTracker::restartSegment(const qint64 t_offset /* =0 */)
+{
+	t_segment_mono_ = clock_.getMonotonicMSec();
+	timer_offset_ = t_offset;
+	syncSegmentStartToClock();
+}
+
+void TimeTracker::syncSegmentStartToClock()
+{
+	// Durations come from the monotonic timer, start times from the wall clock. When the wall clock
+	// is changed (manually, NTP, time zone) both drift apart, so rebase the start times from here on.
+	// Never before the end of the stored segments though, the tracked time must not be overwritten
+	const qint64 t_clock = clock_.getWallMSec() - timer_offset_;
+	const qint64 t_jump = t_clock - segment_start_;
+	if (qAbs(t_jump) > clock_jump_tolerance_msec) {
+		segment_start_ = qMax(t_clock, getStoredEnd());
+		if (settings_.logToFile())
+			Logger::Log("[TIMER] Wall Clock jumped by " + QString::number(t_jump) + "ms");
+	}
+}
+
+void TimeTracker::startTimer(const qint64 t_backdate /* =0 */)
 {
 	if (mode_ == Mode::Pause) {
-		qint64 t_pause = timer_.restart();
-		pauses_.push_back(t_pause);
-		mode_ = Mode::Activity;
+		const qint64 t_pause = getSegmentDuration();
+		const qint64 t_activity = qBound(Q_INT64_C(0), t_backdate, t_pause);
+		addSegment(SegmentType::Pause, t_pause - t_activity);
+		restartSegment(t_activity);
+		setMode(Mode::Activity);
+		emitTransition(Transition::Unpause);
 		if (settings_.logToFile())
 			Logger::Log("[TIMER] > Timer unpaused");
 	}
 	else if (mode_ == Mode::None) {
-		activities_.clear();
-		pauses_.clear();
-		timer_.start();
-		mode_ = Mode::Activity;
+		segments_.clear();
+		t_closed_active_ = 0;
+		t_closed_pause_ = 0;
+		project_totals_.clear();
+		segment_start_ = clock_.getWallMSec();
+		restartSegment();
+		setMode(Mode::Activity);
+		emitTransition(Transition::Start);
 		if (settings_.logToFile())
 			Logger::Log("[TIMER] >> Timer started");
 	}
@@ -34,47 +204,59 @@ void TimeTracker::startTimer()
 void TimeTracker::pauseTimer()
 {
 	if (mode_ == Mode::Activity) {
-		qint64 t_active = timer_.restart();
-		activities_.push_back(t_active);
-		mode_ = Mode::Pause;
+		addSegment(SegmentType::Activity, getSegmentDuration());
+		restartSegment();
+		setMode(Mode::Pause);
+		emitTransition(Transition::Pause);
 		if (settings_.logToFile())
 			Logger::Log("[TIMER] Timer paused <");
 	}
 }
 
-void TimeTracker::backpauseTimer()
+void TimeTracker::backpauseTimer(const qint64 t_backpause)
 {
 	if (mode_ == Mode::Activity) {
 		if (settings_.isAutopauseEnabled()) {
-			qint64 backpause_msec = settings_.getBackpauseMsec();
-			pauses_.push_back(backpause_msec);
-			activities_.push_back(-backpause_msec);
-			if (settings_.logToFile())
+			const qint64 t_active = getSegmentDuration();
+			const qint64 backpause_msec = qBound(Q_INT64_C(0), t_backpause, t_active);
+			addSegment(SegmentType::Activity, t_active - backpause_msec);
+			addSegment(SegmentType::Autopause, backpause_msec);
+			restartSegment();
+			setMode(Mode::Pause);
+			Metrics::count(Metrics::Counter::Autopauses);
+			emitTransition(Transition::Autopause);
+			if (settings_.logToFile()) {
 				Logger::Log("[TIMER] Timer retroactively going to Pause");
+				Logger::Log("[TIMER] Timer paused <");
+			}
+		}
+		else {
+			pauseTimer();
 		}
-		pauseTimer();
 	}
 }
 
 void TimeTracker::stopTimer()
 {
 	if (mode_ == Mode::Pause) {
-		qint64 t_pause = timer_.elapsed();
-		pauses_.push_back(t_pause);
-		mode_ = Mode::None;
+		addSegment(SegmentType::Pause, getSegmentDuration());
+		setMode(Mode::None);
 		if (settings_.logToFile()) {
 			Logger::Log("[TIMER] Timer unpaused < and stopped <<");
 			Logger::Log("[TIMER] Total Activity Time was " + convMSecToTimeStr(getActiveTime()) + ", Total Pause Time was " + convMSecToTimeStr(getPauseTime()));
 		}
+		emit sessionStopped(getSegments());
+		emitTransition(Transition::Stop);
 	}
 	else if (mode_ == Mode::Activity) {
-		qint64 t_active = timer_.elapsed();
-		activities_.push_back(t_active);
-		mode_ = Mode::None;
+		addSegment(SegmentType::Activity, getSegmentDuration());
+		setMode(Mode::None);
 		if (settings_.logToFile()) {
 			Logger::Log("[TIMER] Timer stopped <<");
 			Logger::Log("[TIMER] Total Activity Time was " + convMSecToTimeStr(getActiveTime()) + ", Total Pause Time was " + convMSecToTimeStr(getPauseTime()));
 		}
+		emit sessionStopped(getSegments());
+		emitTransition(Transition::Stop);
 	}
 }
 
@@ -87,12 +269,12 @@ void TimeTracker::useTimerViaButton(Button button) {
 		stopTimer();
 }
 
-void TimeTracker::useTimerViaLockEvent(LockEvent event) {
+void TimeTracker::useTimerViaLockEvent(LockEvent event, qint64 t_elapsed) {
 	if (settings_.isAutopauseEnabled()) {
 		if (event == LockEvent::LongOngoingLock) {
 				if (mode_ == Mode::Activity) {
 					was_active_before_autopause_ = true;
-					backpauseTimer();
+					backpauseTimer(t_elapsed);
 				}
 				else {
 					was_active_before_autopause_ = false;
@@ -100,35 +282,160 @@ void TimeTracker::useTimerViaLockEvent(LockEvent event) {
 			}
 		else if (event == LockEvent::Unlock) {
 			if (was_active_before_autopause_)
-				startTimer();
+				startTimer(t_elapsed);
 			was_active_before_autopause_ = false;
 		}
 	}
 }
 
+void TimeTracker::useTimerViaSleepEvent(qint64 t_mono_suspend, qint64 t_mono_resume, qint64 t_sleep)
+{
+	if (mode_ == Mode::None) {
+		if (settings_.logToFile())
+			Logger::Log("[TIMER] System slept for " + convMSecToTimeStr(t_sleep) + " while Timer was stopped");
+		return;
+	}
+
+	// Whether the monotonic clock kept counting during the sleep depends on the platform clock, so take the
+	// open segment only up to the suspend and restart it at the resume, both measured by the power callback
+	const qint64 t_before = qBound(Q_INT64_C(0), t_mono_suspend - t_segment_mono_ + timer_offset_, getSegmentDuration());
+	const qint64 t_after = qMax(Q_INT64_C(0), clock_.getMonotonicMSec() - t_mono_resume);
+
+	const SegmentType sleep_type = settings_.isSleepCountedAsPause() ? SegmentType::Sleep : getSegmentType();
+	addSegment(getSegmentType(), t_before);
+	addSegment(sleep_type, t_sleep);
+	restartSegment(t_after);
+
+	if (settings_.logToFile())
+		Logger::Log("[TIMER] System slept for " + convMSecToTimeStr(t_sleep) + ", counted as " + ((sleep_type == SegmentType::Activity) ? "Activity" : "Pause"));
+}
+
+void TimeTracker::useTimerViaEdit(qint64 from, qint64 to, SegmentEdit edit)
+{
+	if ((mode_ == Mode::None) || (from >= to)) {
+		if (settings_.logToFile())
+			Logger::Log("[TIMER] Edit ignored, Timer is not running or Range is empty");
+		return;
+	}
+
+	// Running time can't be edited; when the range reaches into it, the open segment is closed first
+	if (to > segment_start_) {
+		addSegment(getSegmentType(), getSegmentDuration());
+		restartSegment();
+		to = qMin(to, segment_start_);
+	}
+	if (from >= to)
+		return;
+
+	// The reclassified time stays with the projects it was tracked for, not the current one
+	const std::vector<TimeSegment> pieces = splitByProject(from, to, (edit == SegmentEdit::Activity) ? SegmentType::Activity : SegmentType::Pause);
+	eraseRange(from, to);
+	if (edit != SegmentEdit::Delete)
+		for (const TimeSegment &piece : pieces)
+			putSegment(piece);
+
+	if (settings_.logToFile())
+		Logger::Log("[TIMER] Edited " + QDateTime::fromMSecsSinceEpoch(from).toString("hh:mm:ss") + " - " + QDateTime::fromMSecsSinceEpoch(to).toString("hh:mm:ss") + " to "
+								+ ((edit == SegmentEdit::Activity) ? "Activity" : ((edit == SegmentEdit::Pause) ? "Pause" : "deleted")));
+	emit segmentsEdited();
+}
+
+void TimeTracker::useTimerViaProject(const QString &name)
+{
+	quint16 project = 0;
+	if (!projects_.getId(name, project)) {
+		if (settings_.logToFile())
+			Logger::Log("[TIMER] Invalid Project Name '" + name + "'");
+		return;
+	}
+	if (project == project_)
+		return;
+
+	// The clock keeps running, only the open segment is handed over to the next project
+	if (mode_ != Mode::None) {
+		addSegment(getSegmentType(), getSegmentDuration());
+		restartSegment();
+	}
+	project_ = project;
+
+	if (settings_.logToFile())
+		Logger::Log("[TIMER] Switched to Project '" + projects_.getName(project) + "'");
+	emit projectChanged(project);
+}
+
+void TimeTracker::useTimerViaDayStart()
+{
+	if (mode_ == Mode::None)
+		return;
+
+	// Close the session at the day start, so each day is archived on its own
+	const Mode mode = mode_;
+	const bool restart = settings_.isRestartAtDayStartEnabled();
+	rolling_over_ = restart;
+	stopTimer();
+	if (!restart)
+		return;
+
+	startTimer();
+	if (mode == Mode::Pause)
+		pauseTimer();
+	rolling_over_ = false;
+	if (settings_.logToFile())
+		Logger::Log("[TIMER] Timer restarted for the new Day");
+}
+
 void TimeTracker::sendTimes()
 {
-	emit sendAllTimes(getActiveTime(), getPauseTime());
+	emit sendAllTimes(TimeSnapshot{getActiveTime(), getPauseTime(), getProjectTotals(project_).active});
 }
 
-qint64 TimeTracker::getActiveTime() const
+TimeTracker::Mode TimeTracker::getMode() const
 {
-	qint64 sum = 0;
-	for(auto & t : activities_)
-		sum += t;
-	if (mode_ == Mode::Activity)
-		sum += timer_.elapsed();
-	return sum;
+	return mode_;
 }
 
-qint64 TimeTracker::getPauseTime() const
+qint64 TimeTracker::getSegmentStart() const
+{
+	return ((mode_ == Mode::None) ? 0 : segment_start_);
+}
+
+std::vector<TimeSegment> TimeTracker::getSegments() const
+{
+	std::vector<TimeSegment> segments;
+	segments.reserve(segments_.size());
+	for (const auto &segment : segments_)
+		segments.push_back(segment.second);
+	return segments;
+}
+
+quint16 TimeTracker::getProject() const
+{
+	return project_;
+}
+
+QString TimeTracker::getProjectName() const
+{
+	return projects_.getName(project_);
+}
+
+TimeTracker::ProjectTotals TimeTracker::getProjectTotals(const quint16 project) const
 {
-	qint64 sum = 0;
-	for(auto & t : pauses_)
-		sum += t;
-	if (mode_ == Mode::Pause)
-		sum += timer_.elapsed();
-	return sum;
+	ProjectTotals totals = (project < project_totals_.size()) ? project_totals_[project] : ProjectTotals{0, 0};
+	if (project == project_) {
+		if (mode_ == Mode::Activity)
+			totals.active += getSegmentDuration();
+		else if (mode_ == Mode::Pause)
+			totals.pause += getSegmentDuration();
+	}
+	return totals;
 }
 
+qint64 TimeTracker::getActiveTime() const
+{
+	return (t_closed_active_ + ((mode_ == Mode::Activity) ? getSegmentDuration() : 0));
+}
 
+qint64 TimeTracker::getPauseTime() const
+{
+	return (t_closed_pause_ + ((mode_ == Mode::Pause) ? getSegmentDuration() : 0));
+}
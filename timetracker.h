@@ -3,44 +3,91 @@
 
 #include <QObject>
 #include <QtGlobal>
-#include <QElapsedTimer>
 #include <vector>
+#include <map>
 #include <memory>
 #include "settings.h"
+#include "projects.h"
+#include "clock.h"
 #include "types.h"
 
 
 class TimeTracker : public QObject
 {
 	Q_OBJECT
-private:
+public:
 	enum class Mode {Activity, Pause, None};
 
+	struct ProjectTotals
+	{
+		qint64 active;
+		qint64 pause;
+	};
+
+private:
 	const Settings & settings_;
-	QElapsedTimer timer_;
-	std::vector<qint64> activities_;
-	std::vector<qint64> pauses_;
+	Projects & projects_;
+	const Clock & clock_;
+	qint64 t_segment_mono_;	// monotonic time the open segment was restarted at
+	qint64 timer_offset_;
+	qint64 segment_start_;
+	std::map<qint64, TimeSegment> segments_;	// by start; never overlapping, so this is an interval index
+	qint64 t_closed_active_;
+	qint64 t_closed_pause_;
+	quint16 project_;
+	std::vector<ProjectTotals> project_totals_;	// closed segments, by project id
 	Mode mode_;
-	bool was_active_before_autopause_;	
+	bool was_active_before_autopause_;
+	bool rolling_over_;
 
-	qint64 getActiveTime() const;
-	qint64 getPauseTime() const;
+	qint64 getSegmentDuration() const;
+	SegmentType getSegmentType() const;
+	void setMode(const Mode mode);
+	void emitTransition(const Transition transition);
+	void addSegment(const SegmentType type, const qint64 duration);
+	void putSegment(const TimeSegment &segment);
+	TimeSegment coalesceWithPrevious(const TimeSegment &segment);
+	void addToTotals(const TimeSegment &segment, const qint64 sign);
+	std::map<qint64, TimeSegment>::iterator takeSegment(std::map<qint64, TimeSegment>::iterator it);
+	void eraseRange(const qint64 from, const qint64 to);
+	std::vector<TimeSegment> splitByProject(const qint64 from, const qint64 to, const SegmentType type) const;
+	qint64 getStoredEnd() const;
+	void restartSegment(const qint64 t_offset = 0);
+	void syncSegmentStartToClock();
 
-	void startTimer();
+	void startTimer(const qint64 t_backdate = 0);
 	void stopTimer();
 	void pauseTimer();
-	void backpauseTimer();
+	void backpauseTimer(const qint64 t_backpause);
 
 public:
-	explicit TimeTracker(const Settings & settings, QObject *parent = nullptr);
+	explicit TimeTracker(const Settings & settings, Projects & projects, const Clock & clock = Clock::getSystemClock(), QObject *parent = nullptr);
 	~TimeTracker();
+	Mode getMode() const;
+	qint64 getActiveTime() const;
+	qint64 getPauseTime() const;
+	qint64 getSegmentStart() const;
+	std::vector<TimeSegment> getSegments() const;
+	quint16 getProject() const;
+	QString getProjectName() const;
+	ProjectTotals getProjectTotals(const quint16 project) const;
 
 signals:
-	void sendAllTimes(qint64 t_active, qint64 t_pause);
+	void sendAllTimes(const TimeSnapshot &times);
+	void modeChanged(TimeTracker::Mode mode);
+	void sessionStopped(const std::vector<TimeSegment> &segments);
+	void segmentAdded(const TimeSegment &segment);
+	void segmentsEdited();
+	void projectChanged(quint16 project);
+	void transitioned(Transition transition, qint64 t_active, qint64 t_pause, const QString &project);
 
 public slots:
 	void useTimerViaButton(Button button);
-	void useTimerViaLockEvent(LockEvent event);
+	void useTimerViaLockEvent(LockEvent event, qint64 t_elapsed);
+	void useTimerViaSleepEvent(qint64 t_mono_suspend, qint64 t_mono_resume, qint64 t_sleep);
+	void useTimerViaEdit(qint64 from, qint64 to, SegmentEdit edit);
+	void useTimerViaProject(const QString &name);
+	void useTimerViaDayStart();
 	void sendTimes();
 };
 
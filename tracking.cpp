@@ -0,0 +1,44 @@
+#include "tracking.h"
+
+namespace {
+	const int tick_interval_msec = 100;
+}
+
+Tracking::Tracking(const Settings &settings)
+	: tick_watchdog(settings, tick_interval_msec),
+		lockstate_watcher(settings),
+		powerstate_watcher(settings),
+		inputidle_watcher(settings),
+		foreground_watcher(settings),
+		day_rollover(settings),
+		history_store(settings, "history.dat"),
+		segment_archive(settings, "segments.dat"),
+		shared_history(settings, "shared-history.dat"),
+		hook_runner(settings),
+		projects(settings, "projects.txt"),
+		note_store(settings, "notes.txt"),
+		time_tracker(settings, projects)
+{
+	QObject::connect(&timer, &QTimer::timeout, &tick_watchdog, &TickWatchdog::update);
+
+	QObject::connect(&timer, &QTimer::timeout, &lockstate_watcher, &LockStateWatcher::update);
+	QObject::connect(&inputidle_watcher, &InputIdleWatcher::inputIdle, &lockstate_watcher, &LockStateWatcher::registerInputIdle);
+	QObject::connect(&inputidle_watcher, &InputIdleWatcher::inputResumed, &lockstate_watcher, &LockStateWatcher::registerInputResumed);
+	QObject::connect(&lockstate_watcher, &LockStateWatcher::desktopLockEvent,	&time_tracker, &TimeTracker::useTimerViaLockEvent);
+
+	QObject::connect(&powerstate_watcher, &PowerStateWatcher::systemSlept, &time_tracker, &TimeTracker::useTimerViaSleepEvent);
+
+	QObject::connect(&powerstate_watcher, &PowerStateWatcher::systemSlept, &day_rollover, &DayRollover::rearm);
+	QObject::connect(&day_rollover, &DayRollover::dayStarted, &time_tracker, &TimeTracker::useTimerViaDayStart);
+
+	QObject::connect(&time_tracker, &TimeTracker::modeChanged, &foreground_watcher, &ForegroundWatcher::reactOnModeChange);
+
+	QObject::connect(&time_tracker, &TimeTracker::sessionStopped, &history_store, &HistoryStore::addSession);
+	QObject::connect(&time_tracker, &TimeTracker::sessionStopped, &segment_archive, &SegmentArchive::addSession);
+	QObject::connect(&time_tracker, &TimeTracker::sessionStopped, &shared_history, &SharedHistory::addSession);
+	QObject::connect(&time_tracker, &TimeTracker::sessionStopped, &foreground_watcher, &ForegroundWatcher::addSession);
+
+	QObject::connect(&time_tracker, &TimeTracker::transitioned, &hook_runner, &HookRunner::runHook);
+
+	timer.setInterval(tick_interval_msec);
+}
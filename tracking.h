@@ -0,0 +1,41 @@
+#ifndef TRACKING_H
+#define TRACKING_H
+
+#include <QTimer>
+#include "settings.h"
+#include "timetracker.h"
+#include "lockstatewatcher.h"
+#include "tickwatchdog.h"
+#include "powerstatewatcher.h"
+#include "inputidlewatcher.h"
+#include "foregroundwatcher.h"
+#include "historystore.h"
+#include "segmentarchive.h"
+#include "projects.h"
+#include "sharedhistory.h"
+#include "hookrunner.h"
+#include "dayrollover.h"
+#include "notestore.h"
+
+// Everything that tracks time; shared by the GUI and the headless mode, so both behave identically
+struct Tracking
+{
+	QTimer timer;
+	TickWatchdog tick_watchdog;
+	LockStateWatcher lockstate_watcher;
+	PowerStateWatcher powerstate_watcher;
+	InputIdleWatcher inputidle_watcher;
+	ForegroundWatcher foreground_watcher;
+	DayRollover day_rollover;
+	HistoryStore history_store;
+	SegmentArchive segment_archive;
+	SharedHistory shared_history;
+	HookRunner hook_runner;	// outlives time_tracker, so the stop on exit still runs its hook
+	Projects projects;
+	NoteStore note_store;
+	TimeTracker time_tracker;
+
+	explicit Tracking(const Settings &settings);
+};
+
+#endif // TRACKING_H
@@ -0,0 +1,73 @@
+#include "trayiconrenderer.h"
+#include <QPainter>
+#include <QColor>
+#include <QPen>
+
+namespace {
+	const int icon_size = 32;
+	const int ring_width = 4;
+	const qint64 progress_steps = 100;
+
+	QColor getModeColor(const TimeTracker::Mode mode)
+	{
+		if (mode == TimeTracker::Mode::Activity)
+			return QColor(0,160,0);
+		else if (mode == TimeTracker::Mode::Pause)
+			return QColor(230,140,0);
+		else
+			return QColor(140,140,140);
+	}
+}
+
+TrayIconRenderer::TrayIconRenderer() : clock_(":/clock.png"), current_key_(-1)
+{ }
+
+bool TrayIconRenderer::update(const TimeTracker::Mode mode, const qint64 &t_progress, const qint64 &t_target)
+{
+	const int step = (t_target > 0) ? static_cast<int>(qBound(Q_INT64_C(0), (t_progress * progress_steps) / t_target, progress_steps)) : 0;
+	const int key = static_cast<int>(mode) * static_cast<int>(progress_steps + 1) + step;
+	if (key == current_key_)
+		return false;
+
+	current_key_ = key;
+	if (!cache_.contains(key)) {
+		// Keys are bounded by 3 modes x 101 steps, so the cache simply keeps every frame ever drawn
+		cache_.insert(key, render(mode, step));
+	}
+	return true;
+}
+
+QIcon TrayIconRenderer::getIcon() const
+{
+	return cache_.value(current_key_);
+}
+
+QIcon TrayIconRenderer::render(const TimeTracker::Mode mode, const int step) const
+{
+	QPixmap pixmap(icon_size, icon_size);
+	pixmap.fill(Qt::transparent);
+
+	QPainter painter(&pixmap);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+	const int inset = ring_width;
+	const QRect clock_rect(inset, inset, icon_size - 2*inset, icon_size - 2*inset);
+	painter.setPen(Qt::NoPen);
+	painter.setBrush(getModeColor(mode));
+	painter.drawEllipse(clock_rect);
+	painter.drawPixmap(clock_rect.adjusted(2, 2, -2, -2), clock_);
+
+	const QRectF ring_rect(ring_width / 2.0, ring_width / 2.0, icon_size - ring_width, icon_size - ring_width);
+	painter.setBrush(Qt::NoBrush);
+	painter.setPen(QPen(QColor(0,0,0,60), ring_width));
+	painter.drawEllipse(ring_rect);
+	if (step > 0) {
+		// Clockwise from 12 o'clock; angles are in 1/16 degrees and positive means counter-clockwise
+		painter.setPen(QPen(getModeColor(mode).darker(130), ring_width, Qt::SolidLine, Qt::FlatCap));
+		painter.drawArc(ring_rect, 90 * 16, -static_cast<int>((step * 360 * 16) / progress_steps));
+	}
+	painter.end();
+
+	return QIcon(pixmap);
+}
@@ -0,0 +1,28 @@
+#ifndef TRAYICONRENDERER_H
+#define TRAYICONRENDERER_H
+
+#include <QtGlobal>
+#include <QIcon>
+#include <QPixmap>
+#include <QHash>
+#include "timetracker.h"
+
+// Renders the tray icon as the clock in the mode's color with a progress ring around it.
+// Progress is quantized to percent steps and every rendered frame is kept, so while the
+// step doesn't change the tray icon isn't touched at all.
+class TrayIconRenderer
+{
+private:
+	const QPixmap clock_;
+	QHash<int, QIcon> cache_;
+	int current_key_;
+
+	QIcon render(const TimeTracker::Mode mode, const int step) const;
+
+public:
+	TrayIconRenderer();
+	bool update(const TimeTracker::Mode mode, const qint64 &t_progress, const qint64 &t_target);
+	QIcon getIcon() const;
+};
+
+#endif // TRAYICONRENDERER_H
@@ -1,8 +1,33 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <QtGlobal>
+
 enum class Button {Start, Pause, Stop};
 
 enum class LockEvent {None, Unlock, Lock, LongOngoingLock};
 
+enum class SegmentType {Activity, Pause, Autopause, Sleep};
+
+enum class SegmentEdit {Activity, Pause, Delete};
+
+enum class Transition {Start, Pause, Autopause, Unpause, Stop, Warning};
+const int transition_count = 6;
+
+struct TimeSegment
+{
+	SegmentType type;
+	qint64 start;		// msec since epoch
+	qint64 duration;	// msec
+	quint16 project;	// id in Projects, 0 is the default project
+};
+
+// Everything the 10 Hz tick shows, taken at once
+struct TimeSnapshot
+{
+	qint64 active;		// msec
+	qint64 pause;		// msec
+	qint64 project_active;	// msec, of the current project
+};
+
 #endif // TYPES_H
@@ -4,7 +4,37 @@ HEADERS = \
    $$PWD/contentwidget.h \
    $$PWD/mainwin.h \
    $$PWD/timetracker.h \
+   $$PWD/clock.h \
+   $$PWD/tracking.h \
    $$PWD/lockstatewatcher.h \
+   $$PWD/tickwatchdog.h \
+   $$PWD/powerstatewatcher.h \
+   $$PWD/inputidlewatcher.h \
+   $$PWD/foregroundwatcher.h \
+   $$PWD/controlprotocol.h \
+   $$PWD/controlserver.h \
+   $$PWD/controlclient.h \
+   $$PWD/metrics.h \
+   $$PWD/metricsserver.h \
+   $$PWD/startupprofiler.h \
+   $$PWD/theme.h \
+   $$PWD/trayiconrenderer.h \
+   $$PWD/historystore.h \
+   $$PWD/segmentarchive.h \
+   $$PWD/reportengine.h \
+   $$PWD/reportdialog.h \
+   $$PWD/exporter.h \
+   $$PWD/historymodel.h \
+   $$PWD/historywindow.h \
+   $$PWD/timelinewidget.h \
+   $$PWD/segmenteditdialog.h \
+   $$PWD/stringinterner.h \
+   $$PWD/projects.h \
+   $$PWD/sharedhistory.h \
+   $$PWD/hookrunner.h \
+   $$PWD/dayrollover.h \
+   $$PWD/notestore.h \
+   $$PWD/notesearchdialog.h \
    $$PWD/settings.h \
    $$PWD/types.h \
    $$PWD/helpers.h \
@@ -15,7 +45,36 @@ SOURCES = \
    $$PWD/main.cpp \
    $$PWD/mainwin.cpp \
    $$PWD/timetracker.cpp \
+   $$PWD/clock.cpp \
+   $$PWD/tracking.cpp \
    $$PWD/lockstatewatcher.cpp \
+   $$PWD/tickwatchdog.cpp \
+   $$PWD/powerstatewatcher.cpp \
+   $$PWD/inputidlewatcher.cpp \
+   $$PWD/foregroundwatcher.cpp \
+   $$PWD/controlserver.cpp \
+   $$PWD/controlclient.cpp \
+   $$PWD/metrics.cpp \
+   $$PWD/metricsserver.cpp \
+   $$PWD/startupprofiler.cpp \
+   $$PWD/theme.cpp \
+   $$PWD/trayiconrenderer.cpp \
+   $$PWD/historystore.cpp \
+   $$PWD/segmentarchive.cpp \
+   $$PWD/reportengine.cpp \
+   $$PWD/reportdialog.cpp \
+   $$PWD/exporter.cpp \
+   $$PWD/historymodel.cpp \
+   $$PWD/historywindow.cpp \
+   $$PWD/timelinewidget.cpp \
+   $$PWD/segmenteditdialog.cpp \
+   $$PWD/stringinterner.cpp \
+   $$PWD/projects.cpp \
+   $$PWD/sharedhistory.cpp \
+   $$PWD/hookrunner.cpp \
+   $$PWD/dayrollover.cpp \
+   $$PWD/notestore.cpp \
+   $$PWD/notesearchdialog.cpp \
    $$PWD/settings.cpp \
    $$PWD/helpers.cpp \
    $$PWD/logger.cpp
@@ -27,7 +86,7 @@ TEMPLATE = app
 
 CONFIG += qt c++14
 
-QT += widgets
+QT += widgets network concurrent
 
 LIBS += -lUser32
 
@@ -0,0 +1,33 @@
+#include <QCoreApplication>
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+#include <cstdio>
+
+#include "controlclient.h"
+
+// Usage: utimerctl [command [argument ...] [+ command [argument ...]] ...]
+// e.g. "utimerctl status" or "utimerctl edit 12:05 12:50 pause + status"
+// All commands are sent at once and the responses are printed one per line.
+int main(int argc, char *argv[])
+{
+	QCoreApplication application(argc, argv);
+
+	QStringList commands = groupControlCommands(application.arguments().mid(1));
+	if (commands.isEmpty())
+		commands << "status";
+
+	QList<QByteArray> responses;
+	if (!sendControlRequests(commands, responses)) {
+		std::fprintf(stderr, "uTimer is not running or doesn't respond\n");
+		return 2;
+	}
+
+	int exit_code = 0;
+	for (const QByteArray &response : responses) {
+		if (!response.startsWith("OK"))
+			exit_code = 1;
+		std::printf("%s\n", response.constData());
+	}
+	return exit_code;
+}
@@ -0,0 +1,20 @@
+TARGET = utimerctl
+
+HEADERS = \
+   $$PWD/../controlprotocol.h \
+   $$PWD/../controlclient.h
+
+SOURCES = \
+   $$PWD/main.cpp \
+   $$PWD/../controlclient.cpp
+
+INCLUDEPATH = \
+    $$PWD/..
+
+TEMPLATE = app
+
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+QT -= gui
+QT += network